@@ -3,6 +3,36 @@ import mysql.connector
 import sys
 import json
 
+def insert_fa_rows(cursor, automaton_id, fa):
+    state_id_map = {}
+    for state in fa["states"]:
+        cursor.execute("insert into States (automaton_id,state_name) values (%s,%s)",(automaton_id,state))
+        state_id_map[state] = cursor.lastrowid
+    
+    cursor.execute("update automata set start_state_id = %s where automaton_id = %s",
+                    (state_id_map[fa["startState"]], automaton_id))
+    symbol_id_map = {}
+    for symbol in fa["alphabet"]:
+        cursor.execute("insert into AlphabetSymbols (automaton_id,symbol_value) values (%s,%s)",
+                        (automaton_id, symbol))
+        symbol_id_map[symbol] = cursor.lastrowid
+        
+    for acc in fa["acceptingStates"]:
+        cursor.execute("insert into AcceptingStates (automaton_id,state_id) values (%s,%s)",
+                        (automaton_id, state_id_map[acc])) 
+        
+    for (src, sym, dst) in fa["transitions"]:
+        cursor.execute("""
+        insert into Transitions (automaton_id, current_state_id, symbol_id, next_state_id)
+                                    values (%s,%s,%s,%s)
+        """,(
+            automaton_id,
+            state_id_map[src],
+            symbol_id_map[sym],
+            state_id_map[dst]
+        )
+        )
+
 def insert_fa(fa,db_config):
     db = None
     cursor = None
@@ -19,35 +49,7 @@ def insert_fa(fa,db_config):
         fa["numOfAcceptingStates"]
         ))
         automaton_id = cursor.lastrowid
-
-        state_id_map = {}
-        for state in fa["states"]:
-            cursor.execute("insert into States (automaton_id,state_name) values (%s,%s)",(automaton_id,state))
-            state_id_map[state] = cursor.lastrowid
-        
-        cursor.execute("update automata set start_state_id = %s where automaton_id = %s",
-                        (state_id_map[fa["startState"]], automaton_id))
-        symbol_id_map = {}
-        for symbol in fa["alphabet"]:
-            cursor.execute("insert into AlphabetSymbols (automaton_id,symbol_value) values (%s,%s)",
-                            (automaton_id, symbol))
-            symbol_id_map[symbol] = cursor.lastrowid
-            
-        for acc in fa["acceptingStates"]:
-            cursor.execute("insert into AcceptingStates (automaton_id,state_id) values (%s,%s)",
-                            (automaton_id, state_id_map[acc])) 
-            
-        for (src, sym, dst) in fa["transitions"]:
-            cursor.execute("""
-            insert into Transitions (automaton_id, current_state_id, symbol_id, next_state_id)
-                                        values (%s,%s,%s,%s)
-            """,(
-                automaton_id,
-                state_id_map[src],
-                symbol_id_map[sym],
-                state_id_map[dst]
-            )
-            )
+        insert_fa_rows(cursor, automaton_id, fa)
         db.commit()
         return automaton_id  # ✅ Return the automaton ID on success
     except mysql.connector.Error as err:
@@ -59,6 +61,45 @@ def insert_fa(fa,db_config):
         if db:    
             db.close()
 
+# Replace the contents of an existing automaton, keeping its ID
+def update_fa(automaton_id, fa, db_config):
+    db = None
+    cursor = None
+    try:
+        db = mysql.connector.connect(**db_config)
+        cursor = db.cursor()
+        db.start_transaction()
+
+        cursor.execute("""
+        update Automata set name = %s, num_of_states = %s, num_of_alphabet_symbols = %s,
+                            num_of_accepting_states = %s, start_state_id = NULL
+        where automaton_id = %s
+        """,(fa["name"],
+        fa["numOfStates"],
+        fa["numOfAlphabet"],
+        fa["numOfAcceptingStates"],
+        automaton_id
+        ))
+        if cursor.rowcount == 0:
+            db.rollback()
+            print(f" Automaton with ID {automaton_id} not found.")
+            return None
+
+        # Children first, so the foreign keys into States and AlphabetSymbols hold
+        for table in ("Transitions", "AcceptingStates", "States", "AlphabetSymbols"):
+            cursor.execute(f"delete from {table} where automaton_id = %s", (automaton_id,))
+        insert_fa_rows(cursor, automaton_id, fa)
+        db.commit()
+        return automaton_id
+    except mysql.connector.Error as err:
+        db.rollback()
+        print(f" Error updating FA {automaton_id}: {err}")
+    finally:
+        if cursor:
+            cursor.close()
+        if db:    
+            db.close()
+
 def load_fa(automaton_id, db_config):
     try:
         db = mysql.connector.connect(**db_config)
@@ -172,6 +213,27 @@ if __name__ == "__main__":
                 sys.exit(1)
         except Exception as e:
             print(f"ERROR: {e}")
+    elif command == "update":
+        if len(sys.argv) != 4:
+            print("Usage: python db_operation.py update <automaton_id> <json_file>")
+            sys.exit(1)
+
+        automaton_id = int(sys.argv[2])
+        json_file = sys.argv[3]
+        try:
+            with open(json_file, 'r') as f:
+                fa_data = json.load(f)
+
+            result = update_fa(automaton_id, fa_data, db_config)
+            if result is not None:
+                print("SUCCESS")
+                sys.exit(0)
+            else:
+                print("FAILED")
+                sys.exit(1)
+        except Exception as e:
+            print(f"ERROR: {e}")
+            sys.exit(1)
     elif command == "load":
         if len(sys.argv) != 4:
             print("Usage: python db_operation.py load <automaton_id> <output_file>")
@@ -192,7 +254,7 @@ if __name__ == "__main__":
             print(f"ERROR: {e}")
 
     else:
-        print("Unknown command. Use 'insert' or 'load'")
+        print("Unknown command. Use 'insert', 'update' or 'load'")
         sys.exit(1)
 
 
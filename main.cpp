@@ -6,9 +6,833 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstdio>  
+#include <vector>
+#include <bitset>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <tuple>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+// Byte-level ranges matching one UTF-8 encoded code point, e.g.
+// {{0xE0,0xE0},{0xA0,0xBF},{0x80,0xBF}}
+typedef vector<pair<unsigned char,unsigned char>> Utf8Sequence;
+
+void appendUtf8(string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += (char)codePoint;
+    } else if (codePoint < 0x800) {
+        out += (char)(0xC0 | (codePoint >> 6));
+        out += (char)(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += (char)(0xE0 | (codePoint >> 12));
+        out += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codePoint & 0x3F));
+    } else {
+        out += (char)(0xF0 | (codePoint >> 18));
+        out += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        out += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// Split the code point range [lo, hi] into byte range sequences so that every
+// sequence covers a rectangle of encodings. Surrogates are skipped.
+vector<Utf8Sequence> utf8Sequences(uint32_t lo, uint32_t hi) {
+    vector<Utf8Sequence> result;
+    vector<pair<uint32_t,uint32_t>> stack = {{lo, min<uint32_t>(hi, 0x10FFFF)}};
+    while (!stack.empty()) {
+        uint32_t start = stack.back().first, end = stack.back().second;
+        stack.pop_back();
+        if (start > end) continue;
+        if (start <= 0xDFFF && end >= 0xD800) {
+            if (end > 0xDFFF) stack.push_back({0xE000, end});
+            if (start < 0xD800) stack.push_back({start, 0xD7FF});
+            continue;
+        }
+        // Both ends must use the same encoded length
+        bool split = false;
+        for (uint32_t max : {0x7Fu, 0x7FFu, 0xFFFFu}) {
+            if (start <= max && max < end) {
+                stack.push_back({max + 1, end});
+                stack.push_back({start, max});
+                split = true;
+                break;
+            }
+        }
+        if (split) continue;
+        // Continuation bytes must span full 0x80-0xBF ranges below the first differing byte
+        for (int i = 1; i < 4 && !split; i++) {
+            uint32_t mask = (1u << (6 * i)) - 1;
+            if ((start & ~mask) != (end & ~mask)) {
+                if ((start & mask) != 0) {
+                    stack.push_back({(start | mask) + 1, end});
+                    stack.push_back({start, start | mask});
+                    split = true;
+                } else if ((end & mask) != mask) {
+                    stack.push_back({end & ~mask, end});
+                    stack.push_back({start, (end & ~mask) - 1});
+                    split = true;
+                }
+            }
+        }
+        if (split) continue;
+        string startBytes, endBytes;
+        appendUtf8(startBytes, start);
+        appendUtf8(endBytes, end);
+        Utf8Sequence sequence;
+        for (size_t i = 0; i < startBytes.size(); i++) {
+            sequence.push_back({(unsigned char)startBytes[i], (unsigned char)endBytes[i]});
+        }
+        result.push_back(sequence);
+    }
+    return result;
+}
+
+// JSON string body for a single transition symbol; bytes outside printable
+// ASCII are written as \u00XX so UTF-8 automata survive the database round trip
+string jsonEscapeSymbol(char symbol) {
+    unsigned char byte = symbol;
+    if (symbol == '"' || symbol == '\\') return string("\\") + symbol;
+    if (byte >= 0x20 && byte < 0x7F) return string(1, symbol);
+    char escaped[8];
+    snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+    return escaped;
+}
+
+// Minimal readers for the JSON documents db_operation.py writes: top-level
+// keys holding a number, a string, or an array of strings / string arrays.
+size_t jsonFindValue(const string& content, const string& key) {
+    string quoted = "\"" + key + "\"";
+    for (size_t keyPos = content.find(quoted); keyPos != string::npos; keyPos = content.find(quoted, keyPos + 1)) {
+        // A string value equal to the key is not followed by ':'
+        size_t colon = content.find_first_not_of(" \t\r\n", keyPos + quoted.size());
+        if (colon != string::npos && content[colon] == ':') {
+            return content.find_first_not_of(" \t\r\n", colon + 1);
+        }
+    }
+    return string::npos;
+}
+
+bool jsonParseString(const string& content, size_t& pos, string& out) {
+    if (pos >= content.size() || content[pos] != '"') return false;
+    out.clear();
+    for (pos++; pos < content.size() && content[pos] != '"'; pos++) {
+        if (content[pos] != '\\') {
+            out += content[pos];
+            continue;
+        }
+        if (++pos >= content.size()) return false;
+        switch (content[pos]) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                if (pos + 4 >= content.size()) return false;
+                uint32_t codePoint = stoul(content.substr(pos + 1, 4), nullptr, 16);
+                appendUtf8(out, codePoint);
+                pos += 4;
+                break;
+            }
+            default: out += content[pos]; break;
+        }
+    }
+    if (pos >= content.size()) return false;
+    pos++;
+    return true;
+}
+
+// Array of strings, or of string arrays (rows are flattened into 'rows')
+bool jsonParseArray(const string& content, const string& key, vector<vector<string>>& rows) {
+    size_t pos = jsonFindValue(content, key);
+    if (pos == string::npos || content[pos] != '[') return false;
+    rows.clear();
+    vector<string>* row = nullptr;
+    string value;
+    for (pos++; pos < content.size(); ) {
+        char c = content[pos];
+        if (c == '"') {
+            if (!jsonParseString(content, pos, value)) return false;
+            if (row) {
+                row->push_back(value);
+            } else {
+                rows.push_back({value});
+            }
+        } else if (c == '[') {
+            rows.emplace_back();
+            row = &rows.back();
+            pos++;
+        } else if (c == ']') {
+            pos++;
+            if (!row) return true;
+            row = nullptr;
+        } else {
+            pos++;
+        }
+    }
+    return false;
+}
+
+bool jsonParseInt(const string& content, const string& key, int& out) {
+    size_t pos = jsonFindValue(content, key);
+    if (pos == string::npos || !(isdigit((unsigned char)content[pos]) || content[pos] == '-')) return false;
+    out = stoi(content.substr(pos, 12));
+    return true;
+}
+
+bool jsonParseStringValue(const string& content, const string& key, string& out) {
+    size_t pos = jsonFindValue(content, key);
+    return pos != string::npos && jsonParseString(content, pos, out);
+}
+
+// Inverse of jsonEscapeSymbol: a JSON symbol decodes to one code point <= 0xFF
+bool symbolFromJson(const string& value, char& symbol) {
+    if (value.size() == 1) {
+        symbol = value[0];
+        return true;
+    }
+    unsigned char lead = value.size() == 2 ? value[0] : 0;
+    if (lead != 0xC2 && lead != 0xC3) return false;
+    symbol = (char)(((lead & 0x03) << 6) | (value[1] & 0x3F));
+    return true;
+}
+
+// Runtime counters and latency histograms for the simulation and construction
+// engines. Each thread updates its own shard with relaxed atomics, so the
+// hot paths never contend; shards are summed only when a dump is written.
+// Set FA_METRICS_FILE (and optionally FA_METRICS_INTERVAL in seconds and
+// FA_METRICS_FORMAT=json|prometheus) to dump them periodically. Building with
+// -DFA_NO_METRICS compiles every FA_METRIC_* call site out.
+#ifndef FA_NO_METRICS
+class Metrics {
+    public:
+        enum Counter {
+            TRANSITIONS, INPUT_BYTES, MATCHES, SERVER_REQUESTS,
+            DETERMINIZED_STATES, REGEX_STATES, PRODUCT_STATES_BUILT,
+            CACHE_MEMORY_HITS, CACHE_DISK_HITS, CACHE_MISSES, CACHE_EVICTIONS,
+            INCREMENTAL_REFRESHES, FULL_REBUILDS,
+            NUM_COUNTERS
+        };
+        enum Histogram {
+            MATCH_LATENCY, LOAD_LATENCY, SAVE_LATENCY, DETERMINIZE_LATENCY, REGEX_COMPILE_LATENCY,
+            REFRESH_LATENCY, CACHE_LOOKUP_LATENCY,
+            NUM_HISTOGRAMS
+        };
+
+    private:
+        // Bucket i counts observations below 2^i microseconds
+        static constexpr int NUM_BUCKETS = 32;
+        struct Shard {
+            atomic<long long> counters[NUM_COUNTERS];
+            atomic<long long> buckets[NUM_HISTOGRAMS][NUM_BUCKETS];
+            atomic<long long> sumMicros[NUM_HISTOGRAMS];
+            Shard() {
+                for (auto& counter : counters) counter.store(0, memory_order_relaxed);
+                for (auto& histogram : buckets) {
+                    for (auto& bucket : histogram) bucket.store(0, memory_order_relaxed);
+                }
+                for (auto& sum : sumMicros) sum.store(0, memory_order_relaxed);
+            }
+        };
+        struct Totals {
+            long long counters[NUM_COUNTERS] = {};
+            long long buckets[NUM_HISTOGRAMS][NUM_BUCKETS] = {};
+            long long sumMicros[NUM_HISTOGRAMS] = {};
+        };
+
+        mutex lock;
+        // Shards are never freed: a thread's counts outlive the thread
+        vector<Shard*> shards;
+        map<int, size_t> peakMemory;
+        chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+        long long lastDumpBytes = 0;
+        chrono::steady_clock::time_point lastDumpTime = startTime;
+
+        thread exporter;
+        atomic<bool> exporterRunning{false};
+        string exportPath;
+        bool exportPrometheus = false;
+
+        static const char* counterName(int counter) {
+            static const char* names[NUM_COUNTERS] = {
+                "fa_transitions_total", "fa_input_bytes_total", "fa_matches_total", "fa_server_requests_total",
+                "fa_determinized_states_total", "fa_regex_states_total", "fa_product_states_built_total",
+                "fa_cache_memory_hits_total", "fa_cache_disk_hits_total", "fa_cache_misses_total", "fa_cache_evictions_total",
+                "fa_incremental_refreshes_total", "fa_full_rebuilds_total"
+            };
+            return names[counter];
+        }
+        static const char* histogramName(int histogram) {
+            static const char* names[NUM_HISTOGRAMS] = {
+                "fa_match_latency_seconds", "fa_load_latency_seconds", "fa_save_latency_seconds",
+                "fa_determinize_latency_seconds", "fa_regex_compile_latency_seconds", "fa_refresh_latency_seconds",
+                "fa_cache_lookup_latency_seconds"
+            };
+            return names[histogram];
+        }
+
+        Shard& shard() {
+            thread_local Shard* mine = nullptr;
+            if (!mine) {
+                mine = new Shard();
+                lock_guard<mutex> guard(lock);
+                shards.push_back(mine);
+            }
+            return *mine;
+        }
+
+        Totals collect() {
+            Totals totals;
+            lock_guard<mutex> guard(lock);
+            for (Shard* s : shards) {
+                for (int c = 0; c < NUM_COUNTERS; c++) {
+                    totals.counters[c] += s->counters[c].load(memory_order_relaxed);
+                }
+                for (int h = 0; h < NUM_HISTOGRAMS; h++) {
+                    for (int b = 0; b < NUM_BUCKETS; b++) {
+                        totals.buckets[h][b] += s->buckets[h][b].load(memory_order_relaxed);
+                    }
+                    totals.sumMicros[h] += s->sumMicros[h].load(memory_order_relaxed);
+                }
+            }
+            return totals;
+        }
+
+        // Input bytes per second since the previous dump
+        double bytesPerSecond(const Totals& totals) {
+            auto now = chrono::steady_clock::now();
+            double seconds = chrono::duration<double>(now - lastDumpTime).count();
+            double rate = seconds > 0 ? (totals.counters[INPUT_BYTES] - lastDumpBytes) / seconds : 0;
+            lastDumpBytes = totals.counters[INPUT_BYTES];
+            lastDumpTime = now;
+            return rate;
+        }
+
+        string toJSON() {
+            Totals totals = collect();
+            stringstream json;
+            json << "{\n";
+            json << "  \"uptimeSeconds\": " << chrono::duration<double>(chrono::steady_clock::now() - startTime).count() << ",\n";
+            json << "  \"bytesPerSecond\": " << bytesPerSecond(totals) << ",\n";
+            json << "  \"counters\": {";
+            for (int c = 0; c < NUM_COUNTERS; c++) {
+                json << (c ? ", " : "") << "\"" << counterName(c) << "\": " << totals.counters[c];
+            }
+            json << "},\n";
+            json << "  \"histograms\": {";
+            for (int h = 0; h < NUM_HISTOGRAMS; h++) {
+                long long count = 0;
+                json << (h ? ", " : "") << "\"" << histogramName(h) << "\": {\"bucketsMicros\": [";
+                for (int b = 0; b < NUM_BUCKETS; b++) {
+                    json << (b ? ", " : "") << totals.buckets[h][b];
+                    count += totals.buckets[h][b];
+                }
+                json << "], \"count\": " << count << ", \"sumMicros\": " << totals.sumMicros[h] << "}";
+            }
+            json << "},\n";
+            json << "  \"automatonPeakMemoryBytes\": {";
+            lock_guard<mutex> guard(lock);
+            bool first = true;
+            for (const auto& automaton : peakMemory) {
+                json << (first ? "" : ", ") << "\"" << automaton.first << "\": " << automaton.second;
+                first = false;
+            }
+            json << "}\n";
+            json << "}\n";
+            return json.str();
+        }
+
+        string toPrometheus() {
+            Totals totals = collect();
+            stringstream text;
+            for (int c = 0; c < NUM_COUNTERS; c++) {
+                text << "# TYPE " << counterName(c) << " counter\n";
+                text << counterName(c) << " " << totals.counters[c] << "\n";
+            }
+            text << "# TYPE fa_input_bytes_per_second gauge\n";
+            text << "fa_input_bytes_per_second " << bytesPerSecond(totals) << "\n";
+            for (int h = 0; h < NUM_HISTOGRAMS; h++) {
+                const char* name = histogramName(h);
+                long long cumulative = 0;
+                text << "# TYPE " << name << " histogram\n";
+                for (int b = 0; b < NUM_BUCKETS; b++) {
+                    cumulative += totals.buckets[h][b];
+                    text << name << "_bucket{le=\"" << (double)(1LL << b) / 1e6 << "\"} " << cumulative << "\n";
+                }
+                text << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+                text << name << "_sum " << totals.sumMicros[h] / 1e6 << "\n";
+                text << name << "_count " << cumulative << "\n";
+            }
+            text << "# TYPE fa_automaton_peak_memory_bytes gauge\n";
+            lock_guard<mutex> guard(lock);
+            for (const auto& automaton : peakMemory) {
+                text << "fa_automaton_peak_memory_bytes{automaton=\"" << automaton.first << "\"} " << automaton.second << "\n";
+            }
+            return text.str();
+        }
+
+        void exportLoop(int intervalSeconds) {
+            auto next = chrono::steady_clock::now();
+            while (exporterRunning) {
+                if (chrono::steady_clock::now() >= next) {
+                    dump();
+                    next += chrono::seconds(intervalSeconds);
+                }
+                this_thread::sleep_for(chrono::milliseconds(100));
+            }
+        }
+
+    public:
+        static Metrics& instance() {
+            static Metrics metrics;
+            return metrics;
+        }
+
+        ~Metrics() {
+            stopExporter();
+        }
+
+        void add(Counter counter, long long amount) {
+            shard().counters[counter].fetch_add(amount, memory_order_relaxed);
+        }
+
+        // One shard lookup for the three counters every match updates
+        void recordMatch(long long bytes, long long transitions) {
+            Shard& s = shard();
+            s.counters[MATCHES].fetch_add(1, memory_order_relaxed);
+            s.counters[INPUT_BYTES].fetch_add(bytes, memory_order_relaxed);
+            s.counters[TRANSITIONS].fetch_add(transitions, memory_order_relaxed);
+        }
+
+        void observe(Histogram histogram, long long micros) {
+            int bucket = 0;
+            while (bucket < NUM_BUCKETS - 1 && (1LL << bucket) <= micros) bucket++;
+            Shard& s = shard();
+            s.buckets[histogram][bucket].fetch_add(1, memory_order_relaxed);
+            s.sumMicros[histogram].fetch_add(micros, memory_order_relaxed);
+        }
+
+        void recordAutomatonMemory(int id, size_t bytes) {
+            lock_guard<mutex> guard(lock);
+            size_t& peak = peakMemory[id];
+            peak = max(peak, bytes);
+        }
+
+        // Write the current values; the file is replaced atomically
+        void dump() {
+            if (exportPath.empty()) return;
+            string tempPath = exportPath + ".tmp";
+            ofstream file(tempPath, ios::trunc);
+            file << (exportPrometheus ? toPrometheus() : toJSON());
+            file.close();
+            rename(tempPath.c_str(), exportPath.c_str());
+        }
+
+        // Start the periodic dump if FA_METRICS_FILE is set
+        void startExporterFromEnvironment() {
+            const char* path = getenv("FA_METRICS_FILE");
+            if (!path || !*path || exporterRunning) return;
+            const char* interval = getenv("FA_METRICS_INTERVAL");
+            const char* format = getenv("FA_METRICS_FORMAT");
+            exportPath = path;
+            exportPrometheus = format && string(format) == "prometheus";
+            exporterRunning = true;
+            exporter = thread(&Metrics::exportLoop, this, max(1, interval ? atoi(interval) : 10));
+        }
+
+        void stopExporter() {
+            if (!exporterRunning) return;
+            exporterRunning = false;
+            exporter.join();
+            dump();
+        }
+};
+
+class MetricsTimer {
+    private:
+        Metrics::Histogram histogram;
+        chrono::steady_clock::time_point start;
+    public:
+        explicit MetricsTimer(Metrics::Histogram h) : histogram(h), start(chrono::steady_clock::now()) {}
+        ~MetricsTimer() {
+            Metrics::instance().observe(histogram,
+                chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+        }
+};
+
+// Times one call in SAMPLE_EVERY per thread, starting with the first. For
+// calls of a few dozen nanoseconds, such as a compiled DFA match, reading the
+// clock twice would cost several times the call itself; the sampled calls
+// still give the latency distribution.
+class SampledMetricsTimer {
+    private:
+        static constexpr unsigned SAMPLE_EVERY = 64;
+        Metrics::Histogram histogram;
+        bool sampled;
+        chrono::steady_clock::time_point start;
+    public:
+        explicit SampledMetricsTimer(Metrics::Histogram h) : histogram(h) {
+            thread_local unsigned calls = 0;
+            sampled = calls++ % SAMPLE_EVERY == 0;
+            if (sampled) start = chrono::steady_clock::now();
+        }
+        ~SampledMetricsTimer() {
+            if (!sampled) return;
+            Metrics::instance().observe(histogram,
+                chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+        }
+};
+
+#define FA_METRIC_CONCAT_INNER(a, b) a##b
+#define FA_METRIC_CONCAT(a, b) FA_METRIC_CONCAT_INNER(a, b)
+#define FA_METRIC_ADD(counter, amount) Metrics::instance().add(Metrics::counter, (amount))
+#define FA_METRIC_TIMER(histogram) MetricsTimer FA_METRIC_CONCAT(metricsTimer, __LINE__)(Metrics::histogram)
+#define FA_METRIC_SAMPLED_TIMER(histogram) SampledMetricsTimer FA_METRIC_CONCAT(metricsTimer, __LINE__)(Metrics::histogram)
+#define FA_METRIC_MEMORY(id, bytes) Metrics::instance().recordAutomatonMemory((id), (bytes))
+#define FA_METRIC_MATCH(bytes, transitions) Metrics::instance().recordMatch((bytes), (transitions))
+#else
+#define FA_METRIC_ADD(counter, amount) do {} while (0)
+#define FA_METRIC_TIMER(histogram) do {} while (0)
+#define FA_METRIC_SAMPLED_TIMER(histogram) do {} while (0)
+#define FA_METRIC_MEMORY(id, bytes) do {} while (0)
+#define FA_METRIC_MATCH(bytes, transitions) do {} while (0)
+#endif
+
+class DFA;
+
+// 64-bit FNV-1a, used to address cached documents by content
+string contentHash(const string& content) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char byte : content) {
+        hash = (hash ^ byte) * 1099511628211ULL;
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return hex;
+}
+
+// Local cache for DFAs loaded from the database, so repeated loads skip the
+// Python round trip. Parsed DFAs are kept in an in-memory LRU; behind it the
+// JSON documents are stored on disk under the hash of their content, with an
+// index file mapping each automaton ID to the hash of its current version.
+// Several processes may share the directory: every change to the index
+// re-reads it under an exclusive lock on index.lock, and files are written
+// to a temporary name and renamed into place, so readers never see a
+// partial file and no process deletes a blob another one still indexes.
+class AutomatonCache {
+    public:
+        struct Stats {
+            long long memoryHits = 0;
+            long long diskHits = 0;
+            long long misses = 0;
+            long long evictions = 0;
+        };
+
+    private:
+        struct Entry {
+            shared_ptr<const DFA> automaton;
+            string hash;
+            list<int>::iterator position;
+        };
+
+        // One version of index.txt; every save renames a new file into place
+        struct IndexVersion {
+            long long inode = -1;
+            long long size = -1;
+            long long modified = -1;
+            bool operator==(const IndexVersion& other) const {
+                return inode == other.inode && size == other.size && modified == other.modified;
+            }
+        };
+
+        // Holds the cross-process lock on the index for its lifetime
+        class IndexLock {
+            public:
+                explicit IndexLock(const string& path, bool exclusive) {
+#ifndef _WIN32
+                    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+                    if (fd >= 0) flock(fd, exclusive ? LOCK_EX : LOCK_SH);
+#endif
+                }
+                ~IndexLock() {
+#ifndef _WIN32
+                    if (fd >= 0) close(fd);
+#endif
+                }
+            private:
+                int fd = -1;
+        };
+
+        string directory;
+        size_t capacity;
+        list<int> recentlyUsed;
+        map<int, Entry> entries;
+        map<int, string> index;
+        IndexVersion loadedIndex;
+        Stats stats;
+        mutable mutex lock;
+
+        string indexPath() const { return directory + "/index.txt"; }
+        string lockPath() const { return directory + "/index.lock"; }
+        string blobPath(const string& hash) const { return directory + "/" + hash + ".json"; }
+
+        static bool readFile(const string& path, string& content) {
+            ifstream file(path, ios::binary);
+            if (!file.is_open()) return false;
+            stringstream buffer;
+            buffer << file.rdbuf();
+            content = buffer.str();
+            return true;
+        }
+
+        // Write next to 'path' and rename over it
+        static bool writeFileAtomically(const string& path, const string& content) {
+#ifdef _WIN32
+            string temporary = path + ".tmp";
+#else
+            string temporary = path + ".tmp." + to_string(getpid());
+#endif
+            {
+                ofstream file(temporary, ios::binary | ios::trunc);
+                if (!file.is_open()) return false;
+                file << content;
+                if (!file.flush()) {
+                    file.close();
+                    remove(temporary.c_str());
+                    return false;
+                }
+            }
+#ifdef _WIN32
+            // rename() does not replace an existing file here
+            remove(path.c_str());
+#endif
+            if (rename(temporary.c_str(), path.c_str()) != 0) {
+                remove(temporary.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        IndexVersion currentIndexVersion() const {
+            IndexVersion version;
+#ifndef _WIN32
+            struct stat info;
+            if (stat(indexPath().c_str(), &info) == 0) {
+                version.inode = info.st_ino;
+                version.size = info.st_size;
+                version.modified = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+            }
+#endif
+            return version;
+        }
+
+        // Replace the in-memory index with the one on disk; call with the index lock held
+        void loadIndex() {
+            loadedIndex = currentIndexVersion();
+            index.clear();
+            ifstream file(indexPath());
+            int id;
+            string hash;
+            while (file >> id >> hash) {
+                index[id] = hash;
+            }
+        }
+
+        // Call with the exclusive index lock held
+        void saveIndex() {
+            stringstream content;
+            for (const auto& entry : index) {
+                content << entry.first << " " << entry.second << "\n";
+            }
+            if (writeFileAtomically(indexPath(), content.str())) {
+                loadedIndex = currentIndexVersion();
+            }
+        }
+
+        // Reload the index only if another process replaced it since the last
+        // load; where the file cannot be identified, always reload
+        void refreshIndex() {
+            IndexVersion version = currentIndexVersion();
+            if (version.inode >= 0 && version == loadedIndex) return;
+            IndexLock indexLock(lockPath(), false);
+            loadIndex();
+        }
+
+        // Remove a blob once no ID refers to it any more; call with the
+        // exclusive index lock held and the index freshly loaded
+        void releaseBlob(const string& hash) {
+            for (const auto& entry : index) {
+                if (entry.second == hash) return;
+            }
+            remove(blobPath(hash).c_str());
+        }
+
+        void touch(int id, shared_ptr<const DFA> automaton, const string& hash) {
+            auto known = entries.find(id);
+            if (known != entries.end()) {
+                recentlyUsed.erase(known->second.position);
+                entries.erase(known);
+            }
+            recentlyUsed.push_front(id);
+            entries[id] = {automaton, hash, recentlyUsed.begin()};
+            while (entries.size() > capacity) {
+                entries.erase(recentlyUsed.back());
+                recentlyUsed.pop_back();
+                stats.evictions++;
+                FA_METRIC_ADD(CACHE_EVICTIONS, 1);
+            }
+        }
+
+        // Drop 'id' from memory and disk. With 'expectedHash' set, the disk
+        // entry is only dropped if it still names that version, so a newer
+        // one stored meanwhile by another process survives.
+        void forget(int id, const string& expectedHash = "") {
+            auto known = entries.find(id);
+            if (known != entries.end()) {
+                recentlyUsed.erase(known->second.position);
+                entries.erase(known);
+            }
+            IndexLock indexLock(lockPath(), true);
+            loadIndex();
+            auto indexed = index.find(id);
+            if (indexed != index.end() && (expectedHash.empty() || indexed->second == expectedHash)) {
+                string hash = indexed->second;
+                index.erase(indexed);
+                releaseBlob(hash);
+                saveIndex();
+            }
+        }
+
+    public:
+        AutomatonCache(const string& dir, size_t maxEntries) : directory(dir), capacity(max<size_t>(1, maxEntries)) {
+#ifdef _WIN32
+            _mkdir(directory.c_str());
+#else
+            mkdir(directory.c_str(), 0755);
+#endif
+            IndexLock indexLock(lockPath(), false);
+            loadIndex();
+        }
+
+        static AutomatonCache& instance() {
+            static AutomatonCache cache("fa_cache", 512);
+            return cache;
+        }
+
+        // Memory hit: 'automaton' is set. Disk hit: 'content' holds the verified
+        // document for the caller to parse and store(). Returns false on a miss.
+        // A memory hit only counts while the index still names the version it
+        // was parsed from; otherwise another process changed it and the disk
+        // copy decides.
+        bool lookup(int id, shared_ptr<const DFA>& automaton, string& content) {
+            lock_guard<mutex> guard(lock);
+            auto known = entries.find(id);
+            if (known != entries.end()) {
+                refreshIndex();
+                auto indexed = index.find(id);
+                if (indexed != index.end() && indexed->second == known->second.hash) {
+                    automaton = known->second.automaton;
+                    recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, known->second.position);
+                    stats.memoryHits++;
+                    FA_METRIC_ADD(CACHE_MEMORY_HITS, 1);
+                    return true;
+                }
+                recentlyUsed.erase(known->second.position);
+                entries.erase(known);
+            }
+            string hash;
+            {
+                // Pick up versions stored by other processes
+                IndexLock indexLock(lockPath(), false);
+                loadIndex();
+                auto indexed = index.find(id);
+                if (indexed != index.end()) hash = indexed->second;
+                if (!hash.empty() && readFile(blobPath(hash), content) && contentHash(content) == hash) {
+                    stats.diskHits++;
+                    FA_METRIC_ADD(CACHE_DISK_HITS, 1);
+                    return true;
+                }
+            }
+            if (!hash.empty()) {
+                // Missing or corrupted blob
+                forget(id, hash);
+            }
+            stats.misses++;
+            FA_METRIC_ADD(CACHE_MISSES, 1);
+            return false;
+        }
+
+        void store(int id, const string& content, shared_ptr<const DFA> automaton) {
+            lock_guard<mutex> guard(lock);
+            string hash = contentHash(content);
+            IndexLock indexLock(lockPath(), true);
+            loadIndex();
+            auto indexed = index.find(id);
+            if (indexed == index.end() || indexed->second != hash) {
+                if (writeFileAtomically(blobPath(hash), content)) {
+                    string previous = indexed == index.end() ? "" : indexed->second;
+                    index[id] = hash;
+                    if (!previous.empty()) releaseBlob(previous);
+                    saveIndex();
+                }
+            }
+            touch(id, automaton, hash);
+        }
+
+        // Drop an automaton whose stored version has changed
+        void invalidate(int id) {
+            lock_guard<mutex> guard(lock);
+            forget(id);
+        }
+
+        Stats getStats() const {
+            lock_guard<mutex> guard(lock);
+            return stats;
+        }
+
+        void displayStats() const {
+            Stats current = getStats();
+            long long lookups = current.memoryHits + current.diskHits + current.misses;
+            lock_guard<mutex> guard(lock);
+            cout << "\n DFA Cache Statistics:" << endl;
+            cout << "-------------------" << endl;
+            cout << " Cached in memory : " << entries.size() << " / " << capacity << endl;
+            cout << " Cached on disk   : " << index.size() << endl;
+            cout << " Memory hits      : " << current.memoryHits << endl;
+            cout << " Disk hits        : " << current.diskHits << endl;
+            cout << " Misses           : " << current.misses << endl;
+            cout << " Evictions        : " << current.evictions << endl;
+            if (lookups > 0) {
+                cout << " Hit rate         : " << (100.0 * (current.memoryHits + current.diskHits) / lookups) << "%" << endl;
+            }
+            cout << endl;
+        }
+};
+
 class FiniteAutoMaton {
     protected:
         set<string> states;
@@ -16,10 +840,10 @@ class FiniteAutoMaton {
         string startState;
         set<string> acceptingStates;
         string name;
-        int numOfStates;
-        int numOfAlphabet;
-        int numOfAcceptingStates;
-        int id;
+        int numOfStates = 0;
+        int numOfAlphabet = 0;
+        int numOfAcceptingStates = 0;
+        int id = 0;
     public:
         virtual void loadFromDatabase(int id) = 0;
         virtual bool simulate(const string& input) = 0;
@@ -64,6 +888,9 @@ class FiniteAutoMaton {
         virtual set<string>& getStates(){
             return states;
         }
+        virtual const set<string>& getStates() const {
+            return states;
+        }
         virtual set<char> getAlphabet(){
             return alphabets;
         } 
@@ -79,94 +906,921 @@ class FiniteAutoMaton {
         virtual int getNumOfAcceptingState(){
             return numOfAcceptingStates;
         }
+        virtual int getId() const {
+            return id;
+        }
+    protected:
+        // Fields shared by DFA and NFA documents; transition rows are left to the caller
+        bool readFieldsFromJSON(const string& content, vector<vector<string>>& transitionRows) {
+            jsonParseStringValue(content, "name", name);
+            jsonParseStringValue(content, "startState", startState);
+            jsonParseInt(content, "id", id);
+            jsonParseInt(content, "numOfStates", numOfStates);
+            jsonParseInt(content, "numOfAlphabet", numOfAlphabet);
+            jsonParseInt(content, "numOfAcceptingStates", numOfAcceptingStates);
+            vector<vector<string>> rows;
+            if (jsonParseArray(content, "states", rows)) {
+                for (const auto& row : rows) states.insert(row[0]);
+            }
+            char symbol;
+            if (jsonParseArray(content, "alphabet", rows)) {
+                for (const auto& row : rows) {
+                    if (symbolFromJson(row[0], symbol)) alphabets.insert(symbol);
+                }
+            }
+            if (jsonParseArray(content, "acceptingStates", rows)) {
+                for (const auto& row : rows) acceptingStates.insert(row[0]);
+            }
+            return jsonParseArray(content, "transitions", transitionRows);
+        }
 };
 
-class DFA : public FiniteAutoMaton {
-    private: 
-        map<pair<string,char>, string> transitions;
-        
+// Structures derived from a DFA and kept up to date from its change log: a
+// dense transition table, the set of reachable states and the partition of
+// states into equivalence classes (the minimal form). Missing transitions
+// lead to an explicit sink state, so states with an empty language share
+// the sink's class. A full build runs Hopcroft's algorithm; an edit only
+// re-refines the classes of the states it touched and of their predecessors,
+// then merges classes whose outgoing classes have become identical.
+// After an edit every class still holds only equivalent states, but the
+// partition is proven minimal (isExact()) only while the quotient has at
+// most REGION_BUDGET classes. Larger automata usually come out of a refresh
+// inexact, since a merge can close a cycle of classes that no local pass
+// sees; minimize() re-runs Hopcroft over the maintained table to settle it.
+class DFAAnalysis {
     public:
-        string toJSON(const string& name) const {
-            stringstream json;
-            json << "{\n";
-            json << "  \"name\": \"" << name << "\",\n";
-            json << "  \"numOfStates\": " << numOfStates << ",\n";
-            json << "  \"numOfAlphabet\": " << numOfAlphabet << ",\n";
-            json << "  \"numOfAcceptingStates\": " << numOfAcceptingStates << ",\n";
-            
-            // States array
-            json << "  \"states\": [";
-            bool first_state = true;
-            for (const auto& state : states) {
-                if (!first_state) json << ", ";
-                json << "\"" << state << "\"";
-                first_state = false;
-            }
-            json << "],\n";
-            
-            // Start state
-            json << "  \"startState\": \"" << startState << "\",\n";
-            
-            // Alphabet array
-            json << "  \"alphabet\": [";
-            bool first_symbol = true;
-            for (const auto& symbol : alphabets) {
-                if (!first_symbol) json << ", ";
-                json << "\"" << string(1, symbol) << "\"";
-                first_symbol = false;
+        struct Change {
+            enum Kind { STATE, SYMBOL, TRANSITION, ACCEPTING, START };
+            Kind kind;
+            string from;
+            char symbol;
+            string to;
+        };
+
+    private:
+        enum { SINK = 0, NO_COLUMN = -1 };
+        struct SignatureHash {
+            size_t operator()(const vector<int>& signature) const {
+                size_t hash = 1469598103934665603ULL;
+                for (int value : signature) {
+                    hash = (hash ^ (size_t)value) * 1099511628211ULL;
+                }
+                return hash;
             }
-            json << "],\n";
-            json << "  \"acceptingStates\": [";
-            bool first_acceptingState = true;
-            for (const auto& state : acceptingStates) {
-                if (!first_acceptingState) json << ", ";
-                json << "\"" << state << "\"";
-                first_acceptingState = false;
+        };
+
+        bool built = false;
+        map<string,int> stateIndex;
+        vector<string> stateNames;
+        int columnOf[256];
+        vector<char> columnSymbol;
+        // columns[c][s]: successor of s on columnSymbol[c]
+        vector<vector<int>> columns;
+        vector<char> accepting;
+        int start = SINK;
+        // One entry per transition s -> t, kept in predecessors[t]; the sink's
+        // list would hold every missing transition, so it is left empty
+        vector<vector<int>> predecessors;
+        vector<int> createdStates;
+
+        // parent[] links every reachable state but the start to a reachable
+        // predecessor, forming a tree rooted at the start. Removing a tree
+        // edge is repaired locally from another predecessor whose tree path
+        // avoids the cut-off state; only when none exists is it recomputed.
+        mutable vector<char> reachable;
+        mutable vector<int> parent;
+        mutable bool reachabilityDirty = false;
+        // False while a merge found by neither the local passes nor the
+        // bounded region pass may be missing from the partition
+        bool exact = false;
+        static constexpr size_t REGION_BUDGET = 4096;
+
+        vector<int> blockOf;
+        vector<vector<int>> blockMembers;
+        vector<int> positionInBlock;
+        vector<int> freeBlocks;
+        vector<vector<int>> blockSignature;
+        unordered_map<vector<int>, int, SignatureHash> signatureIndex;
+
+        int stateId(const string& name) {
+            auto known = stateIndex.find(name);
+            if (known != stateIndex.end()) return known->second;
+            int id = stateNames.size();
+            stateIndex[name] = id;
+            stateNames.push_back(name);
+            accepting.push_back(0);
+            reachable.push_back(0);
+            parent.push_back(SINK);
+            predecessors.emplace_back();
+            for (auto& column : columns) {
+                column.push_back(SINK);
             }
-            json << "],\n";
-            json << "  \"transitions\": [";
-            bool first_transition = true;
-            for (const auto& transition : transitions) {
-                if (!first_transition) json << ", ";
-                // transition.first is pair<string,char>, transition.second is string
-                json << "[\"" << transition.first.first << "\", \"" 
-                        << string(1, transition.first.second) << "\", \"" 
-                        << transition.second << "\"]";
-                first_transition = false;
+            if (!blockMembers.empty()) {
+                createdStates.push_back(id);
+                // New states start alone; the merge pass finds their class
+                int block = newBlock();
+                blockOf.push_back(-1);
+                positionInBlock.push_back(0);
+                moveToBlock(id, block);
             }
-            json << "]\n";
-            json << "}";
-            return json.str();
+            return id;
         }
-        // Parse JSON and populate DFA
-        bool fromJSON(const string& jsonFile) {
-            ifstream file(jsonFile);
-            if (!file.is_open()) {
-                cout << "❌ Failed to open JSON file: " << jsonFile << endl;
-                return false;
+
+        void addColumn(char symbol) {
+            columnOf[(unsigned char)symbol] = columns.size();
+            columnSymbol.push_back(symbol);
+            columns.emplace_back(stateNames.size(), SINK);
+        }
+
+        void setTransition(int from, int column, int to) {
+            int old = columns[column][from];
+            if (old == to) return;
+            if (old != SINK) {
+                vector<int>& oldPredecessors = predecessors[old];
+                auto entry = find(oldPredecessors.begin(), oldPredecessors.end(), from);
+                *entry = oldPredecessors.back();
+                oldPredecessors.pop_back();
+            }
+            if (to != SINK) predecessors[to].push_back(from);
+            columns[column][from] = to;
+            if (reachabilityDirty || !reachable[from]) return;
+            if (old != SINK && old != start && parent[old] == from && !reattach(old, from)) {
+                reachabilityDirty = true;
+            } else if (!reachable[to]) {
+                markReachableFrom(to, from);
+            }
+        }
+
+        // 'state' lost a transition from its tree parent 'from'; find it a
+        // reachable predecessor that does not hang below it in the tree
+        bool reattach(int state, int from) const {
+            for (int p : predecessors[state]) {
+                if (!reachable[p]) continue;
+                if (p == from) return true;
+                int ancestor = p;
+                while (ancestor != start && ancestor != state) ancestor = parent[ancestor];
+                if (ancestor == start) {
+                    parent[state] = p;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Breadth first, so the tree is shallow after a recompute
+        void markReachableFrom(int state, int from) const {
+            if (reachable[state]) return;
+            reachable[state] = 1;
+            parent[state] = from;
+            vector<int> queue = {state};
+            for (size_t i = 0; i < queue.size(); i++) {
+                int s = queue[i];
+                for (const auto& column : columns) {
+                    int t = column[s];
+                    if (!reachable[t]) {
+                        reachable[t] = 1;
+                        parent[t] = s;
+                        queue.push_back(t);
+                    }
+                }
+            }
+        }
+
+        void recomputeReachable() const {
+            fill(reachable.begin(), reachable.end(), 0);
+            markReachableFrom(start, SINK);
+            reachabilityDirty = false;
+        }
+
+        const vector<char>& reachableStates() const {
+            if (reachabilityDirty) recomputeReachable();
+            return reachable;
+        }
+
+        template <class Visit>
+        void forEachPredecessor(int state, Visit visit) const {
+            if (state != SINK) {
+                for (int p : predecessors[state]) visit(p);
+                return;
+            }
+            for (const auto& column : columns) {
+                for (size_t p = 0; p < column.size(); p++) {
+                    if (column[p] == SINK) visit(p);
+                }
+            }
+        }
+
+        vector<int> stateSignature(int state) const {
+            vector<int> signature;
+            signature.reserve(columns.size() + 1);
+            signature.push_back(accepting[state]);
+            for (const auto& column : columns) {
+                signature.push_back(blockOf[column[state]]);
+            }
+            return signature;
+        }
+
+        int newBlock() {
+            if (!freeBlocks.empty()) {
+                int block = freeBlocks.back();
+                freeBlocks.pop_back();
+                return block;
+            }
+            blockMembers.emplace_back();
+            blockSignature.emplace_back();
+            return blockMembers.size() - 1;
+        }
+
+        void moveToBlock(int state, int block) {
+            int old = blockOf[state];
+            if (old >= 0) {
+                vector<int>& members = blockMembers[old];
+                int last = members.back();
+                members[positionInBlock[state]] = last;
+                positionInBlock[last] = positionInBlock[state];
+                members.pop_back();
+                if (members.empty()) {
+                    forgetSignature(old);
+                    freeBlocks.push_back(old);
+                }
+            }
+            blockOf[state] = block;
+            positionInBlock[state] = blockMembers[block].size();
+            blockMembers[block].push_back(state);
+        }
+
+        void forgetSignature(int block) {
+            auto indexed = signatureIndex.find(blockSignature[block]);
+            if (indexed != signatureIndex.end() && indexed->second == block) {
+                signatureIndex.erase(indexed);
+            }
+            blockSignature[block].clear();
+        }
+
+        // Hopcroft's algorithm: the coarsest partition of the nodes of
+        // 'successors' (one vector per symbol) that separates label 0 from 1
+        static vector<int> coarsestPartition(const vector<vector<int>>& successors, const vector<char>& label) {
+            const vector<vector<int>>& columns = successors;
+            int n = label.size();
+            int k = columns.size();
+            vector<vector<int>> inverseStart(k, vector<int>(n + 1, 0));
+            vector<vector<int>> inverse(k, vector<int>(n));
+            for (int c = 0; c < k; c++) {
+                for (int s = 0; s < n; s++) inverseStart[c][columns[c][s] + 1]++;
+                for (int t = 0; t < n; t++) inverseStart[c][t + 1] += inverseStart[c][t];
+                vector<int> fillPosition(inverseStart[c].begin(), inverseStart[c].end() - 1);
+                for (int s = 0; s < n; s++) inverse[c][fillPosition[columns[c][s]]++] = s;
+            }
+
+            // Refinable partition: each block is a range of 'elements'
+            vector<int> elements(n), location(n), block(n);
+            vector<int> blockFirst, blockEnd, marked;
+            for (int pass = 0; pass < 2; pass++) {
+                int first = blockFirst.empty() ? 0 : blockEnd.back();
+                int end = first;
+                for (int s = 0; s < n; s++) {
+                    if (label[s] == pass) {
+                        elements[end] = s;
+                        location[s] = end++;
+                        block[s] = blockFirst.size();
+                    }
+                }
+                if (end > first) {
+                    blockFirst.push_back(first);
+                    blockEnd.push_back(end);
+                    marked.push_back(0);
+                }
+            }
+            vector<int> worklist;
+            vector<char> inWorklist(blockFirst.size(), 1);
+            for (size_t b = 0; b < blockFirst.size(); b++) worklist.push_back(b);
+
+            vector<int> splitter, touched;
+            while (!worklist.empty()) {
+                int a = worklist.back();
+                worklist.pop_back();
+                inWorklist[a] = 0;
+                splitter.assign(elements.begin() + blockFirst[a], elements.begin() + blockEnd[a]);
+                for (int c = 0; c < k; c++) {
+                    touched.clear();
+                    for (int t : splitter) {
+                        for (int i = inverseStart[c][t]; i < inverseStart[c][t + 1]; i++) {
+                            int s = inverse[c][i];
+                            int b = block[s];
+                            int boundary = blockFirst[b] + marked[b];
+                            int other = elements[boundary];
+                            elements[location[s]] = other;
+                            location[other] = location[s];
+                            elements[boundary] = s;
+                            location[s] = boundary;
+                            if (marked[b]++ == 0) touched.push_back(b);
+                        }
+                    }
+                    for (int b : touched) {
+                        int size = blockEnd[b] - blockFirst[b];
+                        if (marked[b] == size) {
+                            marked[b] = 0;
+                            continue;
+                        }
+                        int split = blockFirst.size();
+                        blockFirst.push_back(blockFirst[b]);
+                        blockEnd.push_back(blockFirst[b] + marked[b]);
+                        marked.push_back(0);
+                        inWorklist.push_back(0);
+                        blockFirst[b] += marked[b];
+                        marked[b] = 0;
+                        for (int i = blockFirst[split]; i < blockEnd[split]; i++) block[elements[i]] = split;
+                        if (inWorklist[b] || blockEnd[split] - blockFirst[split] <= blockEnd[b] - blockFirst[b]) {
+                            worklist.push_back(split);
+                            inWorklist[split] = 1;
+                        } else {
+                            worklist.push_back(b);
+                            inWorklist[b] = 1;
+                        }
+                    }
+                }
+            }
+            return block;
+        }
+
+        void hopcroft() {
+            int n = stateNames.size();
+            vector<int> block = coarsestPartition(columns, accepting);
+            blockOf = block;
+            blockMembers.assign(*max_element(block.begin(), block.end()) + 1, vector<int>());
+            positionInBlock.assign(n, 0);
+            for (int s = 0; s < n; s++) {
+                positionInBlock[s] = blockMembers[block[s]].size();
+                blockMembers[block[s]].push_back(s);
+            }
+            freeBlocks.clear();
+            blockSignature.assign(blockMembers.size(), vector<int>());
+            signatureIndex.clear();
+            for (size_t b = 0; b < blockMembers.size(); b++) {
+                blockSignature[b] = stateSignature(blockMembers[b][0]);
+                signatureIndex[blockSignature[b]] = b;
+            }
+        }
+
+        // Local re-refinement after edits to 'dirty' states. First split the
+        // classes whose members no longer agree, spreading to predecessors of
+        // moved states; then merge classes that now have the same signature.
+        // Returns false, leaving the partition unusable, once splitting has
+        // rescanned a quarter of the states; a full rebuild is cheaper then.
+        bool refine(const vector<int>& dirty) {
+            // Nothing changed, so the partition and its exactness stand
+            if (dirty.empty()) return true;
+            size_t workLeft = max<size_t>(1 << 16, stateNames.size() / 4);
+            vector<int> queue;
+            vector<char> queued(blockMembers.size(), 0);
+            auto enqueue = [&](int block) {
+                if (block >= (int)queued.size()) queued.resize(block + 1, 0);
+                if (!queued[block]) {
+                    queued[block] = 1;
+                    queue.push_back(block);
+                }
+            };
+            for (int s : dirty) enqueue(blockOf[s]);
+
+            vector<int> touched;
+            while (!queue.empty()) {
+                int b = queue.back();
+                queue.pop_back();
+                queued[b] = 0;
+                if (blockMembers[b].empty()) continue;
+                if (blockMembers[b].size() > workLeft) return false;
+                workLeft -= blockMembers[b].size();
+                touched.push_back(b);
+                unordered_map<vector<int>, vector<int>, SignatureHash> groups;
+                for (int s : blockMembers[b]) groups[stateSignature(s)].push_back(s);
+                if (groups.size() == 1) continue;
+                // The largest group keeps the block, the others move out
+                auto largest = groups.begin();
+                for (auto group = groups.begin(); group != groups.end(); ++group) {
+                    if (group->second.size() > largest->second.size()) largest = group;
+                }
+                forgetSignature(b);
+                for (auto group = groups.begin(); group != groups.end(); ++group) {
+                    if (group == largest) continue;
+                    int split = newBlock();
+                    touched.push_back(split);
+                    for (int s : group->second) moveToBlock(s, split);
+                }
+                // Only once every group has moved: a predecessor may itself
+                // be in one of them, and its final class is the one to recheck
+                for (auto group = groups.begin(); group != groups.end(); ++group) {
+                    if (group == largest) continue;
+                    for (int s : group->second) {
+                        forEachPredecessor(s, [&](int p) { enqueue(blockOf[p]); });
+                    }
+                }
+            }
+
+            vector<int> seeds = touched;
+            mergeEqualSignatures(touched);
+            // Classes that only merge together as a whole cycle keep distinct
+            // signatures; find those exactly when the region is small enough
+            while (mergeRegion(seeds)) {}
+            return true;
+        }
+
+        // Merge every touched class into a class with the same signature,
+        // spreading to predecessors of the moved states
+        void mergeEqualSignatures(vector<int>& touched) {
+            while (!touched.empty()) {
+                int b = touched.back();
+                touched.pop_back();
+                if (blockMembers[b].empty()) continue;
+                forgetSignature(b);
+                vector<int> signature = stateSignature(blockMembers[b][0]);
+                auto twin = signatureIndex.find(signature);
+                // An entry may be stale if its block is still waiting in 'touched'
+                if (twin != signatureIndex.end() && twin->second != b
+                        && stateSignature(blockMembers[twin->second][0]) != signature) {
+                    blockSignature[twin->second].clear();
+                    signatureIndex.erase(twin);
+                    twin = signatureIndex.end();
+                }
+                if (twin == signatureIndex.end() || twin->second == b) {
+                    signatureIndex[signature] = b;
+                    blockSignature[b] = signature;
+                    continue;
+                }
+                int keep = twin->second, gone = b;
+                if (blockMembers[gone].size() > blockMembers[keep].size()) swap(keep, gone);
+                vector<int> moved = blockMembers[gone];
+                forgetSignature(keep);
+                for (int s : moved) moveToBlock(s, keep);
+                signatureIndex[signature] = keep;
+                blockSignature[keep] = signature;
+                // Predecessors of moved states now point at another class
+                for (int s : moved) {
+                    forEachPredecessor(s, [&](int p) { touched.push_back(blockOf[p]); });
+                }
+            }
+        }
+
+        // Minimize the quotient automaton over the classes reachable from
+        // 'seeds' (over every class if they all fit in REGION_BUDGET) and
+        // merge the classes it finds equivalent. The partition is exact only
+        // if the region covered every class; past the budget it gives up, and
+        // a merge between a class inside the region and one outside is only
+        // caught by minimize(). Returns true if anything was merged; 'seeds'
+        // then holds those classes.
+        bool mergeRegion(vector<int>& seeds) {
+            size_t liveBlocks = blockMembers.size() - freeBlocks.size();
+            if (liveBlocks <= REGION_BUDGET) {
+                seeds.clear();
+                for (size_t b = 0; b < blockMembers.size(); b++) {
+                    if (!blockMembers[b].empty()) seeds.push_back(b);
+                }
+            }
+            unordered_map<int, int> local;
+            vector<int> region;
+            for (int b : seeds) {
+                if (!blockMembers[b].empty() && local.emplace(b, region.size()).second) region.push_back(b);
+            }
+            for (size_t i = 0; i < region.size(); i++) {
+                int representative = blockMembers[region[i]][0];
+                for (const vector<int>& column : columns) {
+                    int next = blockOf[column[representative]];
+                    if (local.emplace(next, region.size()).second) {
+                        region.push_back(next);
+                        if (region.size() > REGION_BUDGET) {
+                            exact = false;
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            vector<vector<int>> successors(columns.size(), vector<int>(region.size()));
+            vector<char> label(region.size());
+            for (size_t i = 0; i < region.size(); i++) {
+                int representative = blockMembers[region[i]][0];
+                label[i] = accepting[representative];
+                for (size_t c = 0; c < columns.size(); c++) {
+                    successors[c][i] = local[blockOf[columns[c][representative]]];
+                }
+            }
+            vector<int> coarse = coarsestPartition(successors, label);
+            exact = region.size() == liveBlocks;
+
+            vector<int> keeper(region.size(), -1);
+            vector<int> moved, touched;
+            for (size_t i = 0; i < region.size(); i++) {
+                int& keep = keeper[coarse[i]];
+                if (keep == -1) {
+                    keep = region[i];
+                    continue;
+                }
+                int gone = region[i];
+                if (blockMembers[gone].size() > blockMembers[keep].size()) swap(keep, gone);
+                forgetSignature(keep);
+                forgetSignature(gone);
+                vector<int> members = blockMembers[gone];
+                for (int s : members) moveToBlock(s, keep);
+                moved.insert(moved.end(), members.begin(), members.end());
+                touched.push_back(keep);
+            }
+            if (touched.empty()) return false;
+            // As in refine(), predecessors are looked up after all moves
+            for (int s : moved) {
+                forEachPredecessor(s, [&](int p) { touched.push_back(blockOf[p]); });
+            }
+            seeds = touched;
+            mergeEqualSignatures(touched);
+            return true;
+        }
+
+    public:
+        DFAAnalysis() {
+            fill(columnOf, columnOf + 256, NO_COLUMN);
+        }
+
+        bool isBuilt() const { return built; }
+        bool isExact() const { return exact; }
+        static size_t getRegionBudget() { return REGION_BUDGET; }
+        void invalidate() { built = false; }
+
+        // Coarsest partition over the current table, without rebuilding it
+        void minimize() {
+            if (exact) return;
+            hopcroft();
+            exact = true;
+        }
+
+        void rebuild(const set<string>& states, const set<char>& alphabet, const set<string>& acceptingStates,
+                     const string& startState, const map<pair<string,char>, string>& transitions) {
+            *this = DFAAnalysis();
+            stateId("");
+            for (char symbol : alphabet) addColumn(symbol);
+            for (const string& state : states) stateId(state);
+            for (const auto& transition : transitions) {
+                unsigned char symbol = transition.first.second;
+                if (columnOf[symbol] == NO_COLUMN) addColumn(symbol);
+                setTransition(stateId(transition.first.first), columnOf[symbol], stateId(transition.second));
+            }
+            for (const string& state : acceptingStates) accepting[stateId(state)] = 1;
+            start = startState.empty() ? SINK : stateId(startState);
+            recomputeReachable();
+            hopcroft();
+            createdStates.clear();
+            built = true;
+            exact = true;
+        }
+
+        // Apply logged edits. Returns false if a full rebuild is needed instead:
+        // a new symbol changes the signature of every class, and an edit may
+        // split too much of the partition to be worth refining locally.
+        bool apply(const vector<Change>& changes) {
+            vector<int> dirty;
+            for (const Change& change : changes) {
+                switch (change.kind) {
+                    case Change::STATE:
+                        dirty.push_back(stateId(change.from));
+                        break;
+                    case Change::SYMBOL:
+                        if (columnOf[(unsigned char)change.symbol] == NO_COLUMN) return false;
+                        break;
+                    case Change::TRANSITION: {
+                        int column = columnOf[(unsigned char)change.symbol];
+                        if (column == NO_COLUMN) return false;
+                        int from = stateId(change.from);
+                        setTransition(from, column, stateId(change.to));
+                        dirty.push_back(from);
+                        break;
+                    }
+                    case Change::ACCEPTING: {
+                        int state = stateId(change.from);
+                        accepting[state] = 1;
+                        dirty.push_back(state);
+                        break;
+                    }
+                    case Change::START:
+                        start = stateId(change.from);
+                        reachabilityDirty = true;
+                        break;
+                }
+            }
+            dirty.insert(dirty.end(), createdStates.begin(), createdStates.end());
+            createdStates.clear();
+            return refine(dirty);
+        }
+
+        bool matches(const string& input) const {
+            int state = start;
+            for (unsigned char byte : input) {
+                int column = columnOf[byte];
+                if (column == NO_COLUMN || state == SINK) return false;
+                state = columns[column][state];
+            }
+            return accepting[state];
+        }
+
+        bool isReachable(const string& state) const {
+            auto known = stateIndex.find(state);
+            return known != stateIndex.end() && reachableStates()[known->second];
+        }
+
+        bool areEquivalent(const string& first, const string& second) const {
+            auto a = stateIndex.find(first), b = stateIndex.find(second);
+            return a != stateIndex.end() && b != stateIndex.end() && blockOf[a->second] == blockOf[b->second];
+        }
+
+        int getNumOfReachableStates() const {
+            const vector<char>& live = reachableStates();
+            int count = 0;
+            for (size_t s = 1; s < live.size(); s++) count += live[s];
+            return count;
+        }
+
+        // Quotient of the reachable states, named q0 (start), q1, ... in BFS order
+        template <class Automaton>
+        void toMinimalDFA(Automaton& minimal) const {
+            int sinkBlock = blockOf[SINK];
+            map<int,string> names;
+            vector<int> order;
+            auto nameOf = [&](int block) -> const string& {
+                auto known = names.find(block);
+                if (known == names.end()) {
+                    known = names.insert({block, "q" + to_string(names.size())}).first;
+                    order.push_back(block);
+                }
+                return known->second;
+            };
+            for (char symbol : columnSymbol) minimal.addSymbol(symbol);
+            int numAccepting = 0;
+            if (blockOf[start] != sinkBlock) {
+                minimal.setStartState(nameOf(blockOf[start]));
+            }
+            for (size_t i = 0; i < order.size(); i++) {
+                int block = order[i];
+                int representative = blockMembers[block][0];
+                string from = names[block];
+                minimal.addStates(from);
+                if (accepting[representative]) {
+                    minimal.addAcceptingStates(from);
+                    numAccepting++;
+                }
+                for (size_t c = 0; c < columns.size(); c++) {
+                    int target = blockOf[columns[c][representative]];
+                    if (target != sinkBlock) {
+                        string to = nameOf(target);
+                        minimal.addTransition(from, columnSymbol[c], to);
+                    }
+                }
+            }
+            minimal.setNumOfState(order.size());
+            minimal.setNumOfAlphabet(columnSymbol.size());
+            minimal.setNumOfAcceptingState(numAccepting);
+        }
+};
+
+// Integer-indexed NFA over bytes, the form RegexCompiler builds directly.
+// Edges carry byte ranges instead of one entry per byte and epsilon moves
+// have their own lists, so a generated automaton stays a few words per
+// state. NFA::loadCompiled expands it into the string-keyed NFA;
+// determinize() turns it into a DFA without leaving the integer form.
+class CompiledNFA {
+    public:
+        struct Edge {
+            unsigned char lo;
+            unsigned char hi;
+            int to;
+        };
+
+    private:
+        vector<vector<Edge>> edges;
+        vector<vector<int>> epsilons;
+        vector<char> accepting;
+        int start = 0;
+
+        void addClosure(int state, vector<int>& set, vector<int>& mark, int stamp) const {
+            if (mark[state] == stamp) return;
+            mark[state] = stamp;
+            set.push_back(state);
+            for (size_t i = set.size() - 1; i < set.size(); i++) {
+                for (int next : epsilons[set[i]]) {
+                    if (mark[next] != stamp) {
+                        mark[next] = stamp;
+                        set.push_back(next);
+                    }
+                }
+            }
+        }
+
+    public:
+        void clear() {
+            edges.clear();
+            epsilons.clear();
+            accepting.clear();
+            start = 0;
+        }
+        int addState() {
+            edges.emplace_back();
+            epsilons.emplace_back();
+            accepting.push_back(0);
+            return edges.size() - 1;
+        }
+        void addEdge(int from, unsigned char lo, unsigned char hi, int to) {
+            edges[from].push_back({lo, hi, to});
+        }
+        void addEpsilon(int from, int to) {
+            epsilons[from].push_back(to);
+        }
+        void setAccepting(int state) { accepting[state] = 1; }
+        void setStart(int state) { start = state; }
+
+        int getNumOfStates() const { return edges.size(); }
+        int getStart() const { return start; }
+        bool isAccepting(int state) const { return accepting[state]; }
+        const vector<Edge>& getEdges(int state) const { return edges[state]; }
+        const vector<int>& getEpsilons(int state) const { return epsilons[state]; }
+
+        // State-set simulation; no determinization needed
+        bool matches(const string& input) const {
+            vector<int> current, next, mark(edges.size(), 0);
+            int stamp = 1;
+            addClosure(start, current, mark, stamp);
+            for (unsigned char byte : input) {
+                stamp++;
+                next.clear();
+                for (int state : current) {
+                    for (const Edge& edge : edges[state]) {
+                        if (edge.lo <= byte && byte <= edge.hi) addClosure(edge.to, next, mark, stamp);
+                    }
+                }
+                current.swap(next);
+                if (current.empty()) return false;
+            }
+            for (int state : current) {
+                if (accepting[state]) return true;
+            }
+            return false;
+        }
+
+        // Subset construction over byte ranges. The result is deterministic:
+        // no epsilon moves, disjoint edges out of every state, start state 0.
+        CompiledNFA determinize() const {
+            FA_METRIC_TIMER(DETERMINIZE_LATENCY);
+            CompiledNFA dfa;
+            if (edges.empty()) return dfa;
+            map<vector<int>, int> subsets;
+            vector<const vector<int>*> members;
+            vector<int> subset, mark(edges.size(), 0), boundaries;
+            vector<vector<int>> targets;
+            int stamp = 1;
+            addClosure(start, subset, mark, stamp);
+            sort(subset.begin(), subset.end());
+            members.push_back(&subsets.insert({subset, 0}).first->first);
+            dfa.addState();
+
+            for (size_t current = 0; current < members.size(); current++) {
+                // Cut the bytes at every edge end; each piece moves as a unit
+                bitset<257> cut;
+                for (int state : *members[current]) {
+                    if (accepting[state]) dfa.setAccepting(current);
+                    for (const Edge& edge : edges[state]) {
+                        cut.set(edge.lo);
+                        cut.set(edge.hi + 1);
+                    }
+                }
+                boundaries.clear();
+                for (int b = 0; b < 257; b++) {
+                    if (cut[b]) boundaries.push_back(b);
+                }
+                targets.assign(boundaries.size(), vector<int>());
+                for (int state : *members[current]) {
+                    for (const Edge& edge : edges[state]) {
+                        size_t piece = lower_bound(boundaries.begin(), boundaries.end(), edge.lo) - boundaries.begin();
+                        for (; boundaries[piece] <= edge.hi; piece++) targets[piece].push_back(edge.to);
+                    }
+                }
+                for (size_t piece = 0; piece + 1 < boundaries.size(); piece++) {
+                    if (targets[piece].empty()) continue;
+                    stamp++;
+                    subset.clear();
+                    for (int target : targets[piece]) addClosure(target, subset, mark, stamp);
+                    sort(subset.begin(), subset.end());
+                    auto known = subsets.insert({subset, members.size()});
+                    if (known.second) {
+                        members.push_back(&known.first->first);
+                        dfa.addState();
+                    }
+                    int to = known.first->second;
+                    unsigned char lo = boundaries[piece], hi = boundaries[piece + 1] - 1;
+                    vector<Edge>& out = dfa.edges[current];
+                    if (!out.empty() && out.back().to == to && out.back().hi + 1 == lo) {
+                        out.back().hi = hi;
+                    } else {
+                        out.push_back({lo, hi, to});
+                    }
+                }
+            }
+            FA_METRIC_ADD(DETERMINIZED_STATES, members.size());
+            return dfa;
+        }
+};
+
+class DFA : public FiniteAutoMaton {
+    private: 
+        map<pair<string,char>, string> transitions;
+        // Edits since the last refresh(); only recorded once the analysis exists
+        DFAAnalysis analysis;
+        vector<DFAAnalysis::Change> changeLog;
+
+        void logChange(DFAAnalysis::Change::Kind kind, const string& from, char symbol = 0, const string& to = "") {
+            if (analysis.isBuilt()) {
+                changeLog.push_back({kind, from, symbol, to});
+            }
+        }
+        
+    public:
+        string toJSON(const string& name) const {
+            stringstream json;
+            json << "{\n";
+            json << "  \"name\": \"" << name << "\",\n";
+            json << "  \"numOfStates\": " << numOfStates << ",\n";
+            json << "  \"numOfAlphabet\": " << numOfAlphabet << ",\n";
+            json << "  \"numOfAcceptingStates\": " << numOfAcceptingStates << ",\n";
+            
+            // States array
+            json << "  \"states\": [";
+            bool first_state = true;
+            for (const auto& state : states) {
+                if (!first_state) json << ", ";
+                json << "\"" << state << "\"";
+                first_state = false;
+            }
+            json << "],\n";
+            
+            // Start state
+            json << "  \"startState\": \"" << startState << "\",\n";
+            
+            // Alphabet array
+            json << "  \"alphabet\": [";
+            bool first_symbol = true;
+            for (const auto& symbol : alphabets) {
+                if (!first_symbol) json << ", ";
+                json << "\"" << jsonEscapeSymbol(symbol) << "\"";
+                first_symbol = false;
+            }
+            json << "],\n";
+            json << "  \"acceptingStates\": [";
+            bool first_acceptingState = true;
+            for (const auto& state : acceptingStates) {
+                if (!first_acceptingState) json << ", ";
+                json << "\"" << state << "\"";
+                first_acceptingState = false;
+            }
+            json << "],\n";
+            json << "  \"transitions\": [";
+            bool first_transition = true;
+            for (const auto& transition : transitions) {
+                if (!first_transition) json << ", ";
+                // transition.first is pair<string,char>, transition.second is string
+                json << "[\"" << transition.first.first << "\", \"" 
+                        << jsonEscapeSymbol(transition.first.second) << "\", \"" 
+                        << transition.second << "\"]";
+                first_transition = false;
+            }
+            json << "]\n";
+            json << "}";
+            return json.str();
+        }
+        // Parse JSON and populate DFA
+        bool fromJSON(const string& jsonFile) {
+            ifstream file(jsonFile);
+            if (!file.is_open()) {
+                cout << "❌ Failed to open JSON file: " << jsonFile << endl;
+                return false;
             }
             string line, content;
             while (getline(file, line)) {
                 content += line;
             }
             file.close();
+            return parseJSON(content);
+        }
+
+        bool parseJSON(const string& content) {
+            // The fields are read straight into the sets, bypassing the change log
+            analysis.invalidate();
             try {
-                // Extract name
-                size_t namePos = content.find("\"name\": \"");
-                if (namePos != string::npos) {
-                    namePos += 9;
-                    size_t endPos = content.find("\"", namePos);
-                    name = content.substr(namePos, endPos - namePos);
+                vector<vector<string>> rows;
+                if (!readFieldsFromJSON(content, rows)) {
+                    cout << "❌ Error parsing JSON file" << endl;
+                    return false;
                 }
-                
-                // Extract startState
-                size_t startPos = content.find("\"startState\": \"");
-                if (startPos != string::npos) {
-                    startPos += 15;
-                    size_t endPos = content.find("\"", startPos);
-                    startState = content.substr(startPos, endPos - startPos);
+                char symbol;
+                for (const auto& row : rows) {
+                    if (row.size() != 3 || !symbolFromJson(row[1], symbol)) {
+                        cout << "❌ Invalid transition in JSON file" << endl;
+                        return false;
+                    }
+                    addTransition(row[0], symbol, row[2]);
                 }
-                
                 return true;
             } catch (...) {
                 cout << "❌ Error parsing JSON file" << endl;
@@ -191,74 +1845,147 @@ class DFA : public FiniteAutoMaton {
             jsonFile << jsonData;
             jsonFile.close();
             
-            // Execute Python script
-            string command = "python db_operation.py insert " + tempFile;
+            // A DFA loaded from the database is written back under its ID;
+            // anything else becomes a new automaton
+            string command = id != 0
+                ? "python db_operation.py update " + to_string(id) + " " + tempFile
+                : "python db_operation.py insert " + tempFile;
             cout << "💾 Saving DFA to database..." << endl;
             
             // Use simple system() call instead of popen
-            int result = system(command.c_str());
+            int result;
+            {
+                FA_METRIC_TIMER(SAVE_LATENCY);
+                result = system(command.c_str());
+            }
             
             // Cleanup temporary file
             remove(tempFile.c_str());
             
             // Just check the result
             if (result == 0) {
+                // The cached copy of an updated automaton is stale now
+                if (id != 0) {
+                    AutomatonCache::instance().invalidate(id);
+                }
                 cout << "✅ DFA '" << dfaName << "' saved to database successfully!" << endl;
             } else {
                 cout << " Failed to save DFA to database!" << endl;
             }
         }
         
-        void loadFromDatabase(int id) override {
-            string tempFile = "temp_dfa_load.json";
-            string command = "python db_operation.py load " + to_string(id) + " " + tempFile;
-            
-            cout << "📂 Loading DFA from database (ID: " << id << ")..." << endl;
-            
-            // ✅ FIXED: Use system() instead of popen
-            int result = system(command.c_str());
-            
-            if (result == 0) {
-                // Check if file was created successfully
-                ifstream checkFile(tempFile);
-                if (checkFile.good()) {
-                    checkFile.close();
-                    if (fromJSON(tempFile)) {
-                        cout << "✅ DFA loaded successfully from database!" << endl;
-                        displayTransitions();
-                    } else {
-                        cout << "❌ Failed to parse loaded DFA data!" << endl;
+        enum LoadResult { LOADED, NOT_FOUND, PARSE_ERROR, DATABASE_ERROR };
+
+        // Load without displaying anything and hand back the shared, immutable
+        // automaton, so a memory hit costs no copy. The local cache is tried
+        // first unless 'useCache' is false; a database load always refreshes
+        // the cache. Null unless 'result' is LOADED.
+        static shared_ptr<const DFA> fetchShared(int id, LoadResult& result, bool useCache = true) {
+            AutomatonCache& cache = AutomatonCache::instance();
+            if (useCache) {
+                // Cache lookups are timed apart from database round trips
+                FA_METRIC_TIMER(CACHE_LOOKUP_LATENCY);
+                shared_ptr<const DFA> cached;
+                string content;
+                if (cache.lookup(id, cached, content)) {
+                    if (cached) {
+                        result = LOADED;
+                        return cached;
                     }
-                    // Cleanup
-                    remove(tempFile.c_str());
-                } else {
-                    cout << "❌ DFA with ID " << id << " not found in database!" << endl;
+                    shared_ptr<DFA> parsed = make_shared<DFA>();
+                    if (parsed->parseJSON(content)) {
+                        cache.store(id, content, parsed);
+                        result = LOADED;
+                        return parsed;
+                    }
+                    cache.invalidate(id);
                 }
-            } else {
-                cout << "❌ Error loading DFA from database!" << endl;
+            }
+
+            FA_METRIC_TIMER(LOAD_LATENCY);
+            string content;
+            string tempFile = "temp_dfa_load_" + to_string(id) + ".json";
+            string command = "python db_operation.py load " + to_string(id) + " " + tempFile;
+            int status = system(command.c_str());
+            if (status != 0) {
+                result = DATABASE_ERROR;
+                return nullptr;
+            }
+            // Check if file was created successfully
+            ifstream loadedFile(tempFile, ios::binary);
+            if (!loadedFile.good()) {
+                result = NOT_FOUND;
+                return nullptr;
+            }
+            stringstream buffer;
+            buffer << loadedFile.rdbuf();
+            loadedFile.close();
+            remove(tempFile.c_str());
+            content = buffer.str();
+            shared_ptr<DFA> loaded = make_shared<DFA>();
+            if (!loaded->parseJSON(content)) {
+                result = PARSE_ERROR;
+                return nullptr;
+            }
+            cache.store(id, content, loaded);
+            result = LOADED;
+            return loaded;
+        }
+
+        // Load into this DFA, for callers that go on to edit it; everyone
+        // else should share the cached automaton through fetchShared().
+        LoadResult fetchFromDatabase(int id, bool useCache = true) {
+            LoadResult result;
+            shared_ptr<const DFA> loaded = fetchShared(id, result, useCache);
+            *this = loaded ? *loaded : DFA();
+            return result;
+        }
+
+        void loadFromDatabase(int id) override {
+            cout << "📂 Loading DFA from database (ID: " << id << ")..." << endl;
+            switch (fetchFromDatabase(id)) {
+                case LOADED:
+                    cout << "✅ DFA loaded successfully from database!" << endl;
+                    displayTransitions();
+                    break;
+                case PARSE_ERROR:
+                    cout << "❌ Failed to parse loaded DFA data!" << endl;
+                    break;
+                case NOT_FOUND:
+                    cout << "❌ DFA with ID " << id << " not found in database!" << endl;
+                    break;
+                case DATABASE_ERROR:
+                    cout << "❌ Error loading DFA from database!" << endl;
+                    break;
             }
         }
         
         bool simulate(const string& input) override {
+            FA_METRIC_TIMER(MATCH_LATENCY);
             string currentState = startState;
             cout << "🔍 Simulating input: '" << input << "'" << endl;
             cout << "▶️  Start state: " << currentState << endl;
             
-            for (char symbol : input) {
+            // Transitions taken so far equal the position in the input
+            for (size_t i = 0; i < input.size(); i++) {
+                char symbol = input[i];
                 if (alphabets.find(symbol) == alphabets.end()) {
                     cout << "❌ Symbol '" << symbol << "' not in alphabet!" << endl;
+                    FA_METRIC_MATCH(input.size(), i);
                     return false;
                 }
                 
                 auto transition = transitions.find({currentState, symbol});
                 if (transition == transitions.end()) {
                     cout << "❌ No transition from " << currentState << " with symbol " << symbol << endl;
+                    FA_METRIC_MATCH(input.size(), i);
                     return false;
                 }
                 
                 cout << "   " << currentState << " --" << symbol << "--> " << transition->second << endl;
                 currentState = transition->second;
             }
+            FA_METRIC_MATCH(input.size(), input.size());
             
             bool accepted = acceptingStates.find(currentState) != acceptingStates.end();
             cout << " Final state: " << currentState;
@@ -266,8 +1993,79 @@ class DFA : public FiniteAutoMaton {
             return accepted;
         }
         
+        // Bulk load of a deterministic CompiledNFA (see CompiledNFA::determinize),
+        // naming state i "q<i>" like NFA::loadCompiled
+        void loadCompiled(const CompiledNFA& deterministic) {
+            analysis.invalidate();
+            changeLog.clear();
+            int n = deterministic.getNumOfStates();
+            vector<string> names(n);
+            for (int i = 0; i < n; i++) names[i] = "q" + to_string(i);
+
+            states.clear();
+            acceptingStates.clear();
+            alphabets.clear();
+            transitions.clear();
+            bitset<256> used;
+            for (int i = 0; i < n; i++) {
+                states.insert(names[i]);
+                if (deterministic.isAccepting(i)) acceptingStates.insert(names[i]);
+                for (const CompiledNFA::Edge& edge : deterministic.getEdges(i)) {
+                    for (int b = edge.lo; b <= edge.hi; b++) {
+                        transitions[{names[i], (char)b}] = names[edge.to];
+                        used.set(b);
+                    }
+                }
+            }
+            for (int b = 0; b < 256; b++) {
+                if (used[b]) alphabets.insert((char)b);
+            }
+            startState = n > 0 ? names[deterministic.getStart()] : string();
+            numOfStates = n;
+            numOfAlphabet = alphabets.size();
+            numOfAcceptingStates = acceptingStates.size();
+        }
         void addTransition(const string& from, char symbol, const string& to) {
             transitions[{from, symbol}] = to;
+            logChange(DFAAnalysis::Change::TRANSITION, from, symbol, to);
+        }
+        void addSymbol(char symbol) override {
+            FiniteAutoMaton::addSymbol(symbol);
+            logChange(DFAAnalysis::Change::SYMBOL, "", symbol);
+        }
+        void addStates(string& state) override {
+            FiniteAutoMaton::addStates(state);
+            logChange(DFAAnalysis::Change::STATE, state);
+        }
+        void addAcceptingStates(const string& state) override {
+            FiniteAutoMaton::addAcceptingStates(state);
+            logChange(DFAAnalysis::Change::ACCEPTING, state);
+        }
+        void setAcceptingStates(const string& state) override {
+            addAcceptingStates(state);
+        }
+        void setStartState(const string& state) override {
+            FiniteAutoMaton::setStartState(state);
+            logChange(DFAAnalysis::Change::START, state);
+        }
+
+        // Bring the compiled table, reachability and minimal form up to date.
+        // Logged edits are applied in place; a long log, a new symbol or a
+        // bulk load triggers a full rebuild. The classes are always sound, but
+        // on large automata only minimal if isExact(); 'exact' makes sure of
+        // it by re-minimizing the table when the local passes could not.
+        const DFAAnalysis& refresh(bool exact = false) {
+            FA_METRIC_TIMER(REFRESH_LATENCY);
+            size_t rebuildThreshold = max<size_t>(1024, states.size() / 8);
+            if (!analysis.isBuilt() || changeLog.size() > rebuildThreshold || !analysis.apply(changeLog)) {
+                analysis.rebuild(states, alphabets, acceptingStates, startState, transitions);
+                FA_METRIC_ADD(FULL_REBUILDS, 1);
+            } else {
+                FA_METRIC_ADD(INCREMENTAL_REFRESHES, 1);
+            }
+            changeLog.clear();
+            if (exact) analysis.minimize();
+            return analysis;
         }
         void displayTransitions() const {
             cout << "\n Transition Table:" << endl;
@@ -386,10 +2184,474 @@ class DFA : public FiniteAutoMaton {
 };
 
 
+// Dense table form of a DFA for matching without the verbose trace. Bytes that
+// no state tells apart share a column (a range table over the byte alphabet),
+// so a UTF-8 automaton needs a handful of columns instead of 256 and input is
+// matched byte by byte without decoding code points.
+class CompiledDFA {
+    public:
+        enum { DEAD = -1 };
+
+    private:
+        unsigned char byteClass[256];
+        int numClasses = 1;
+        int start = DEAD;
+        vector<int> table;
+        vector<char> accepting;
+
+        // Split byte classes until every state sends all bytes of a class to the same state
+        void buildByteClasses(const map<pair<string,char>, string>& transitions, const map<string,int>& index) {
+            vector<int> classOf(256, 0);
+            vector<int> classSize = {256};
+            auto transition = transitions.begin();
+            while (transition != transitions.end()) {
+                const string& from = transition->first.first;
+                map<pair<int,int>, vector<int>> groups;
+                for (; transition != transitions.end() && transition->first.first == from; ++transition) {
+                    unsigned char byte = transition->first.second;
+                    groups[{classOf[byte], index.at(transition->second)}].push_back(byte);
+                }
+                map<int,int> groupsPerClass;
+                for (const auto& group : groups) {
+                    groupsPerClass[group.first.first]++;
+                }
+                for (const auto& group : groups) {
+                    int oldClass = group.first.first;
+                    if (groupsPerClass[oldClass] == 1 && (int)group.second.size() == classSize[oldClass]) continue;
+                    int newClass = classSize.size();
+                    classSize.push_back(group.second.size());
+                    classSize[oldClass] -= group.second.size();
+                    for (int byte : group.second) {
+                        classOf[byte] = newClass;
+                    }
+                }
+            }
+            // Renumber densely in byte order
+            map<int,int> dense;
+            for (int b = 0; b < 256; b++) {
+                auto known = dense.insert({classOf[b], dense.size()}).first;
+                byteClass[b] = known->second;
+            }
+            numClasses = dense.size();
+        }
+
+    public:
+        CompiledDFA() {
+            fill(byteClass, byteClass + 256, 0);
+        }
+
+        explicit CompiledDFA(const DFA& dfa) {
+            const map<pair<string,char>, string>& transitions = dfa.getTransitions();
+            map<string,int> index;
+            auto addState = [&](const string& state) {
+                index.insert({state, index.size()});
+            };
+            for (const string& state : dfa.getStates()) addState(state);
+            for (const auto& transition : transitions) {
+                addState(transition.first.first);
+                addState(transition.second);
+            }
+            if (!dfa.getStartState().empty()) addState(dfa.getStartState());
+
+            buildByteClasses(transitions, index);
+            table.assign(index.size() * numClasses, DEAD);
+            for (const auto& transition : transitions) {
+                int from = index[transition.first.first];
+                table[from * numClasses + byteClass[(unsigned char)transition.first.second]] = index[transition.second];
+            }
+            accepting.assign(index.size(), 0);
+            for (const string& state : dfa.getAcceptingStates()) {
+                auto known = index.find(state);
+                if (known != index.end()) accepting[known->second] = 1;
+            }
+            auto startIndex = index.find(dfa.getStartState());
+            start = startIndex == index.end() ? DEAD : startIndex->second;
+        }
+
+        // From CompiledNFA::determinize output, skipping the string-keyed DFA.
+        // Byte classes are the same coarsest partition the DFA overload finds.
+        explicit CompiledDFA(const CompiledNFA& deterministic) {
+            int n = deterministic.getNumOfStates();
+            // Bytes between two edge ends behave alike in every state
+            bitset<257> cut;
+            cut.set(0);
+            for (int state = 0; state < n; state++) {
+                for (const CompiledNFA::Edge& edge : deterministic.getEdges(state)) {
+                    cut.set(edge.lo);
+                    cut.set(edge.hi + 1);
+                }
+            }
+            vector<int> pieceOf(256);
+            int numPieces = 0;
+            for (int b = 0; b < 256; b++) {
+                if (cut[b]) numPieces++;
+                pieceOf[b] = numPieces - 1;
+            }
+            vector<int> pieces((size_t)n * numPieces, DEAD);
+            for (int state = 0; state < n; state++) {
+                for (const CompiledNFA::Edge& edge : deterministic.getEdges(state)) {
+                    for (int piece = pieceOf[edge.lo]; piece <= pieceOf[edge.hi]; piece++) {
+                        pieces[(size_t)state * numPieces + piece] = edge.to;
+                    }
+                }
+            }
+            // Pieces every state sends to the same place share a class;
+            // classes are numbered in byte order
+            map<vector<int>, int> classOfColumn;
+            vector<int> classOfPiece(numPieces);
+            vector<int> column(n);
+            for (int piece = 0; piece < numPieces; piece++) {
+                for (int state = 0; state < n; state++) column[state] = pieces[(size_t)state * numPieces + piece];
+                classOfPiece[piece] = classOfColumn.insert({column, classOfColumn.size()}).first->second;
+            }
+            numClasses = classOfColumn.size();
+            for (int b = 0; b < 256; b++) byteClass[b] = classOfPiece[pieceOf[b]];
+
+            table.assign((size_t)n * numClasses, DEAD);
+            for (int state = 0; state < n; state++) {
+                for (int piece = 0; piece < numPieces; piece++) {
+                    table[(size_t)state * numClasses + classOfPiece[piece]] = pieces[(size_t)state * numPieces + piece];
+                }
+            }
+            accepting.assign(n, 0);
+            for (int state = 0; state < n; state++) accepting[state] = deterministic.isAccepting(state);
+            start = n > 0 ? deterministic.getStart() : DEAD;
+        }
+
+        bool matches(const string& input) const {
+            FA_METRIC_SAMPLED_TIMER(MATCH_LATENCY);
+            int state = start;
+            const unsigned char* bytes = (const unsigned char*)input.data();
+            size_t i = 0;
+            for (; i < input.size() && state != DEAD; i++) {
+                state = table[state * numClasses + byteClass[bytes[i]]];
+            }
+            FA_METRIC_MATCH(input.size(), i);
+            return state != DEAD && accepting[state];
+        }
+
+        int getStartState() const { return start; }
+        // Bytes in the same class move every state alike
+        int getByteClass(unsigned char byte) const { return byteClass[byte]; }
+        int step(int state, unsigned char byte) const {
+            return table[state * numClasses + byteClass[byte]];
+        }
+        bool isAccepting(int state) const { return accepting[state]; }
+        int getNumOfStates() const { return accepting.size(); }
+        int getNumOfClasses() const { return numClasses; }
+        size_t memoryUsage() const {
+            return sizeof(*this) + table.size() * sizeof(int) + accepting.size();
+        }
+};
+
+
+// Evaluates one input against many DFAs in a single pass. A product state is
+// the list of (automaton, state) pairs still able to accept; product states
+// and their transitions are built lazily the first time an input reaches
+// them, so once warm every input byte costs one table lookup regardless of
+// how many automata are loaded. Automata that can no longer accept drop out
+// of the product, and an empty product ends the pass early.
+// The product cache is bounded by MAX_PRODUCT_BYTES unless the constructor
+// is given another limit, and starts over when full. Misses while it fills are expected, but if it has had to start over
+// and the hit rate still stays under MIN_HIT_PERCENT, the inputs reach more
+// product states than fit: building them costs more than it saves, so the
+// automata are stepped one by one instead, and the product is retried after
+// DIRECT_RETRY_STEPS automaton transitions (again overridable), enough work
+// that refilling the cache is cheap in comparison.
+class MultiDFA {
+    private:
+        enum { UNKNOWN = -1 };
+        static constexpr size_t MAX_PRODUCT_BYTES = 64 << 20;
+        static constexpr long long HIT_RATE_WINDOW = 1 << 14;
+        static constexpr long long MIN_HIT_PERCENT = 75;
+        static constexpr long long DIRECT_RETRY_STEPS = 1 << 28;
+        typedef vector<pair<int,int>> Members;
+
+        size_t maxProductBytes;
+        long long directRetrySteps;
+        vector<int> ids;
+        vector<shared_ptr<const CompiledDFA>> automata;
+        // live[a][s]: an accepting state of automaton a is reachable from s
+        vector<vector<char>> live;
+
+        bool prepared = false;
+        unsigned char byteClass[256];
+        vector<unsigned char> classByte;
+        int numClasses = 0;
+
+        vector<Members> productMembers;
+        vector<vector<int>> productAccepting;
+        vector<int> productNext;
+        map<Members, int> productIndex;
+        size_t productBytes = 0;
+        long long productStatesBuilt = 0;
+
+        // Product lookups and misses since the last hit rate check, which
+        // only starts once the cache has overflowed
+        bool overflowed = false;
+        long long windowSteps = 0;
+        long long windowMisses = 0;
+        bool direct = false;
+        long long directSteps = 0;
+
+        static vector<char> liveStates(const CompiledDFA& dfa) {
+            int n = dfa.getNumOfStates();
+            vector<vector<int>> predecessors(n);
+            for (int s = 0; s < n; s++) {
+                for (int b = 0; b < 256; b++) {
+                    int t = dfa.step(s, b);
+                    if (t != CompiledDFA::DEAD && (predecessors[t].empty() || predecessors[t].back() != s)) {
+                        predecessors[t].push_back(s);
+                    }
+                }
+            }
+            vector<char> result(n, 0);
+            vector<int> stack;
+            for (int s = 0; s < n; s++) {
+                if (dfa.isAccepting(s)) {
+                    result[s] = 1;
+                    stack.push_back(s);
+                }
+            }
+            while (!stack.empty()) {
+                int t = stack.back();
+                stack.pop_back();
+                for (int s : predecessors[t]) {
+                    if (!result[s]) {
+                        result[s] = 1;
+                        stack.push_back(s);
+                    }
+                }
+            }
+            return result;
+        }
+
+        // Bytes that every automaton treats alike share one product column:
+        // the common refinement of the automata's own byte classes
+        void buildByteClasses() {
+            vector<int> classOf(256, 0);
+            int count = 1;
+            // Refined class of each (current class, automaton class) pair seen so far
+            vector<int> refined(256 * 256, -1);
+            vector<int> used;
+            for (const auto& automaton : automata) {
+                int next = 0;
+                for (int b = 0; b < 256; b++) {
+                    int key = classOf[b] * 256 + automaton->getByteClass(b);
+                    if (refined[key] < 0) {
+                        refined[key] = next++;
+                        used.push_back(key);
+                    }
+                    classOf[b] = refined[key];
+                }
+                for (int key : used) refined[key] = -1;
+                used.clear();
+                count = next;
+                if (count == 256) break;
+            }
+            // Labels are handed out in byte order, so they are already dense
+            classByte.assign(count, 0);
+            for (int b = 255; b >= 0; b--) {
+                byteClass[b] = classOf[b];
+                classByte[classOf[b]] = b;
+            }
+            numClasses = count;
+        }
+
+        void clearProductStates() {
+            // Swap with empties so the memory is returned, not just emptied
+            vector<Members>().swap(productMembers);
+            vector<vector<int>>().swap(productAccepting);
+            vector<int>().swap(productNext);
+            productIndex.clear();
+            productBytes = 0;
+        }
+
+        // Approximate heap footprint of one product state: its members (held
+        // by productMembers and again as the productIndex key), the map node
+        // and its accepting IDs. productNext is counted by its capacity.
+        static size_t productStateBytes(size_t members, size_t accepting) {
+            return 2 * (sizeof(Members) + members * sizeof(pair<int,int>)) + 4 * sizeof(void*) + sizeof(int)
+                + sizeof(vector<int>) + accepting * sizeof(int);
+        }
+
+        size_t productCacheBytes() const {
+            return productBytes + productNext.capacity() * sizeof(int);
+        }
+
+        int intern(const Members& members) {
+            auto known = productIndex.find(members);
+            if (known != productIndex.end()) return known->second;
+            int product = productMembers.size();
+            productIndex[members] = product;
+            productMembers.push_back(members);
+            vector<int> accepting;
+            for (const auto& member : members) {
+                if (automata[member.first]->isAccepting(member.second)) accepting.push_back(ids[member.first]);
+            }
+            sort(accepting.begin(), accepting.end());
+            productAccepting.push_back(accepting);
+            productNext.resize(productNext.size() + numClasses, UNKNOWN);
+            productBytes += productStateBytes(members.size(), accepting.size());
+            productStatesBuilt++;
+            FA_METRIC_ADD(PRODUCT_STATES_BUILT, 1);
+            return product;
+        }
+
+        Members startMembers() const {
+            Members members;
+            for (size_t a = 0; a < automata.size(); a++) {
+                int start = automata[a]->getStartState();
+                if (start != CompiledDFA::DEAD && live[a][start]) members.push_back({a, start});
+            }
+            return members;
+        }
+
+        int buildNext(int product, int column) {
+            Members next;
+            unsigned char byte = classByte[column];
+            for (const auto& member : productMembers[product]) {
+                int t = automata[member.first]->step(member.second, byte);
+                if (t != CompiledDFA::DEAD && live[member.first][t]) next.push_back({member.first, t});
+            }
+            if (productCacheBytes() >= maxProductBytes) {
+                // Cache full: start over, the current input only needs 'next'
+                clearProductStates();
+                overflowed = true;
+                intern(startMembers());
+                return intern(next);
+            }
+            int target = intern(next);
+            productNext[product * numClasses + column] = target;
+            return target;
+        }
+
+        void prepare() {
+            buildByteClasses();
+            clearProductStates();
+            intern(startMembers());
+            overflowed = false;
+            windowSteps = windowMisses = 0;
+            direct = false;
+            prepared = true;
+        }
+
+        // 'transitions' counts product lookups plus the automaton steps
+        // taken to build missing product states
+        vector<int> evaluateProduct(const string& input, long long& transitions) {
+            int product = 0;
+            for (unsigned char byte : input) {
+                if (productMembers[product].empty()) break;
+                int column = byteClass[byte];
+                int next = productNext[product * numClasses + column];
+                windowSteps++;
+                transitions++;
+                if (next == UNKNOWN) {
+                    windowMisses++;
+                    transitions += productMembers[product].size();
+                    next = buildNext(product, column);
+                }
+                product = next;
+            }
+            vector<int> accepted = productAccepting[product];
+            if (!overflowed) {
+                windowSteps = windowMisses = 0;
+                return accepted;
+            }
+            // Misses past the window's allowance decide early
+            bool overBudget = 100 * windowMisses > (100 - MIN_HIT_PERCENT) * HIT_RATE_WINDOW;
+            if (windowSteps >= HIT_RATE_WINDOW || overBudget) {
+                if (overBudget || 100 * (windowSteps - windowMisses) < MIN_HIT_PERCENT * windowSteps) {
+                    // Hit rate collapsed: free the cache and step the automata directly
+                    clearProductStates();
+                    direct = true;
+                    directSteps = 0;
+                }
+                windowSteps = windowMisses = 0;
+            }
+            return accepted;
+        }
+
+        vector<int> evaluateDirect(const string& input, long long& transitions) {
+            vector<int> accepted;
+            for (size_t a = 0; a < automata.size(); a++) {
+                const CompiledDFA& automaton = *automata[a];
+                const vector<char>& alive = live[a];
+                int state = automaton.getStartState();
+                size_t i = 0;
+                for (; i < input.size() && state != CompiledDFA::DEAD && alive[state]; i++) {
+                    state = automaton.step(state, input[i]);
+                }
+                transitions += i;
+                directSteps += i;
+                if (state != CompiledDFA::DEAD && automaton.isAccepting(state)) accepted.push_back(ids[a]);
+            }
+            sort(accepted.begin(), accepted.end());
+            if (directSteps >= directRetrySteps) {
+                // Inputs may have settled; give the product another chance
+                intern(startMembers());
+                overflowed = false;
+                direct = false;
+            }
+            return accepted;
+        }
+
+    public:
+        explicit MultiDFA(size_t maxBytes = MAX_PRODUCT_BYTES, long long retrySteps = DIRECT_RETRY_STEPS)
+            : maxProductBytes(maxBytes), directRetrySteps(retrySteps) {}
+
+        void add(int id, shared_ptr<const CompiledDFA> automaton) {
+            FA_METRIC_MEMORY(id, automaton->memoryUsage());
+            ids.push_back(id);
+            live.push_back(liveStates(*automaton));
+            automata.push_back(automaton);
+            prepared = false;
+        }
+
+        // IDs of the automata accepting 'input', in ascending order
+        vector<int> evaluate(const string& input) {
+            FA_METRIC_TIMER(MATCH_LATENCY);
+            if (!prepared) prepare();
+            long long transitions = 0;
+            vector<int> accepted = direct ? evaluateDirect(input, transitions) : evaluateProduct(input, transitions);
+            FA_METRIC_MATCH(input.size(), transitions);
+            return accepted;
+        }
+
+        int getNumOfAutomata() const { return automata.size(); }
+        int getNumOfProductStates() const { return productMembers.size(); }
+        size_t getProductCacheBytes() const { return productCacheBytes(); }
+        bool isSteppingDirectly() const { return direct; }
+        long long getNumOfProductStatesBuilt() const { return productStatesBuilt; }
+};
+
 class NFA : public FiniteAutoMaton {
     private:
         map<pair<string,char>, set<string>> transitions;
+        // Kept apart from 'transitions' so every byte, '\0' included, is a symbol
+        map<string, set<string>> epsilonTransitions;
         bool isAllowEpsilonTransitions = false; 
+        // Intermediate states of code point ranges, keyed by (next state, byte range).
+        // Not saved with the NFA; a loaded NFA just stops sharing them.
+        map<tuple<string,unsigned char,unsigned char>, string> utf8SuffixStates;
+        int nextSuffixState = 0;
+
+        // A name for a new intermediate state that no state uses yet
+        string newSuffixState() {
+            string name;
+            do {
+                name = "u" + to_string(nextSuffixState++);
+            } while (states.count(name));
+            return name;
+        }
+
+        void addByteRange(const string& from, pair<unsigned char,unsigned char> range, const string& to) {
+            for (int b = range.first; b <= range.second; b++) {
+                addSymbol((char)b);
+                addTransition(from, (char)b, to);
+            }
+            numOfAlphabet = alphabets.size();
+        }
     public:
         // ✅ ADD: Convert NFA to JSON (similar to DFA but handles multiple transitions)
         string toJSON(const string& name) const {
@@ -418,7 +2680,7 @@ class NFA : public FiniteAutoMaton {
             bool first_symbol = true;
             for (const auto& symbol : alphabets) {
                 if (!first_symbol) json << ", ";
-                json << "\"" << string(1, symbol) << "\"";
+                json << "\"" << jsonEscapeSymbol(symbol) << "\"";
                 first_symbol = false;
             }
             json << "],\n";
@@ -445,11 +2707,19 @@ class NFA : public FiniteAutoMaton {
                 for (const string& toState : toStates) {
                     if (!first_transition) json << ", ";
                     json << "[\"" << fromState << "\", \"" 
-                        << string(1, symbol) << "\", \"" 
+                        << jsonEscapeSymbol(symbol) << "\", \"" 
                         << toState << "\"]";
                     first_transition = false;
                 }
             }
+            // Epsilon transitions use an empty symbol
+            for (const auto& transition : epsilonTransitions) {
+                for (const string& toState : transition.second) {
+                    if (!first_transition) json << ", ";
+                    json << "[\"" << transition.first << "\", \"\", \"" << toState << "\"]";
+                    first_transition = false;
+                }
+            }
             json << "]\n";
             json << "}";
             
@@ -472,22 +2742,25 @@ class NFA : public FiniteAutoMaton {
             file.close();
             
             try {
-                // Extract name
-                size_t namePos = content.find("\"name\": \"");
-                if (namePos != string::npos) {
-                    namePos += 9;
-                    size_t endPos = content.find("\"", namePos);
-                    name = content.substr(namePos, endPos - namePos);
+                vector<vector<string>> rows;
+                // Loaded transitions may leave from any intermediate state
+                utf8SuffixStates.clear();
+                if (!readFieldsFromJSON(content, rows)) {
+                    cout << "❌ Error parsing JSON file" << endl;
+                    return false;
                 }
-                
-                // Extract startState
-                size_t startPos = content.find("\"startState\": \"");
-                if (startPos != string::npos) {
-                    startPos += 15;
-                    size_t endPos = content.find("\"", startPos);
-                    startState = content.substr(startPos, endPos - startPos);
+                char symbol;
+                for (const auto& row : rows) {
+                    if (row.size() == 3 && row[1].empty()) {
+                        addEpsilonTransition(row[0], row[2]);
+                        continue;
+                    }
+                    if (row.size() != 3 || !symbolFromJson(row[1], symbol)) {
+                        cout << "❌ Invalid transition in JSON file" << endl;
+                        return false;
+                    }
+                    addTransition(row[0], symbol, row[2]);
                 }
-                
                 return true;
             } catch (...) {
                 cout << "❌ Error parsing JSON file" << endl;
@@ -516,7 +2789,11 @@ class NFA : public FiniteAutoMaton {
             string command = "python db_operation.py insert " + tempFile;
             cout << "💾 Saving NFA to database..." << endl;
             
-            int result = system(command.c_str());
+            int result;
+            {
+                FA_METRIC_TIMER(SAVE_LATENCY);
+                result = system(command.c_str());
+            }
             
             // Cleanup temporary file
             remove(tempFile.c_str());
@@ -554,152 +2831,1783 @@ class NFA : public FiniteAutoMaton {
                 cout << "❌ Error loading NFA from database!" << endl;
             }
         }
-        
-        bool simulate(const string& input) override {
-            cout << "NFA simulation not implemented yet." << endl;
-            return false;
+        
+        // Add every state reachable through epsilon transitions to the set
+        void epsilonClosure(set<string>& current) const {
+            vector<string> stack(current.begin(), current.end());
+            while (!stack.empty()) {
+                string state = stack.back();
+                stack.pop_back();
+                auto transition = epsilonTransitions.find(state);
+                if (transition == epsilonTransitions.end()) continue;
+                for (const string& toState : transition->second) {
+                    if (current.insert(toState).second) {
+                        stack.push_back(toState);
+                    }
+                }
+            }
+        }
+
+        // States reachable from 'current' on 'symbol', epsilon closure included
+        set<string> move(const set<string>& current, char symbol) const {
+            set<string> next;
+            for (const string& state : current) {
+                auto transition = transitions.find({state, symbol});
+                if (transition != transitions.end()) {
+                    next.insert(transition->second.begin(), transition->second.end());
+                }
+            }
+            epsilonClosure(next);
+            return next;
+        }
+
+        static void displayStateSet(const set<string>& stateSet) {
+            cout << "{";
+            bool first = true;
+            for (const string& state : stateSet) {
+                if (!first) cout << ", ";
+                cout << state;
+                first = false;
+            }
+            cout << "}";
+        }
+
+        bool simulate(const string& input) override {
+            set<string> current = {startState};
+            epsilonClosure(current);
+            cout << "🔍 Simulating input: '" << input << "'" << endl;
+            cout << "▶️  Start states: ";
+            displayStateSet(current);
+            cout << endl;
+
+            for (char symbol : input) {
+                if (alphabets.find(symbol) == alphabets.end()) {
+                    cout << "❌ Symbol '" << symbol << "' not in alphabet!" << endl;
+                    return false;
+                }
+                set<string> next = move(current, symbol);
+                cout << "   ";
+                displayStateSet(current);
+                cout << " --" << symbol << "--> ";
+                displayStateSet(next);
+                cout << endl;
+                if (next.empty()) {
+                    cout << "❌ No transition with symbol " << symbol << endl;
+                    return false;
+                }
+                current = next;
+            }
+
+            bool accepted = false;
+            for (const string& state : current) {
+                if (acceptingStates.find(state) != acceptingStates.end()) {
+                    accepted = true;
+                    break;
+                }
+            }
+            cout << " Final states: ";
+            displayStateSet(current);
+            cout << " (" << (accepted ? "✅ ACCEPTED" : " REJECTED") << ")" << endl;
+            return accepted;
+        }
+        
+        void addTransition(const string& from, char symbol, const string& to) {
+            transitions[{from, symbol}].insert(to);
+        }
+        // Transition on every code point in [lo, hi], compiled into byte-level
+        // transitions over the UTF-8 encoding. Intermediate states that lead to
+        // the same state on the same byte range are shared across ranges.
+        void addCodePointRange(const string& from, uint32_t lo, uint32_t hi, const string& to) {
+            for (const Utf8Sequence& sequence : utf8Sequences(lo, hi)) {
+                string next = to;
+                for (size_t i = sequence.size() - 1; i > 0; i--) {
+                    auto key = make_tuple(next, sequence[i].first, sequence[i].second);
+                    auto known = utf8SuffixStates.find(key);
+                    if (known == utf8SuffixStates.end()) {
+                        string state = newSuffixState();
+                        addStates(state);
+                        numOfStates++;
+                        addByteRange(state, sequence[i], next);
+                        known = utf8SuffixStates.insert({key, state}).first;
+                    }
+                    next = known->second;
+                }
+                addByteRange(from, sequence[0], next);
+            }
+        }
+        // Bulk load of a generated automaton: replaces this NFA with 'compiled',
+        // naming state i "q<i>". The tables are filled in key order, so each
+        // insertion is constant time instead of a string-keyed search.
+        void loadCompiled(const CompiledNFA& compiled) {
+            int n = compiled.getNumOfStates();
+            vector<string> names(n);
+            vector<int> order(n);
+            for (int i = 0; i < n; i++) {
+                names[i] = "q" + to_string(i);
+                order[i] = i;
+            }
+            sort(order.begin(), order.end(), [&](int a, int b) { return names[a] < names[b]; });
+            // Target lists are sorted by name too, so sets fill in order
+            vector<int> rank(n);
+            for (int i = 0; i < n; i++) rank[order[i]] = i;
+
+            states.clear();
+            acceptingStates.clear();
+            alphabets.clear();
+            transitions.clear();
+            epsilonTransitions.clear();
+            utf8SuffixStates.clear();
+            vector<vector<int>> targets(256);
+            bitset<256> used;
+            for (int state : order) {
+                const string& from = names[state];
+                states.emplace_hint(states.end(), from);
+                if (compiled.isAccepting(state)) acceptingStates.emplace_hint(acceptingStates.end(), from);
+                for (const CompiledNFA::Edge& edge : compiled.getEdges(state)) {
+                    for (int b = edge.lo; b <= edge.hi; b++) targets[b].push_back(edge.to);
+                }
+                for (int b = 0; b < 256; b++) {
+                    if (targets[b].empty()) continue;
+                    used.set(b);
+                    sort(targets[b].begin(), targets[b].end(), [&](int x, int y) { return rank[x] < rank[y]; });
+                    set<string>& to = transitions.emplace_hint(transitions.end(), make_pair(from, (char)b), set<string>())->second;
+                    for (int target : targets[b]) to.emplace_hint(to.end(), names[target]);
+                    targets[b].clear();
+                }
+                vector<int> epsilon = compiled.getEpsilons(state);
+                if (!epsilon.empty()) {
+                    sort(epsilon.begin(), epsilon.end(), [&](int x, int y) { return rank[x] < rank[y]; });
+                    set<string>& to = epsilonTransitions.emplace_hint(epsilonTransitions.end(), from, set<string>())->second;
+                    for (int target : epsilon) to.emplace_hint(to.end(), names[target]);
+                }
+            }
+            for (int b = 0; b < 256; b++) {
+                if (used[b]) alphabets.insert((char)b);
+            }
+            startState = n > 0 ? names[compiled.getStart()] : string();
+            isAllowEpsilonTransitions = !epsilonTransitions.empty();
+            numOfStates = n;
+            numOfAlphabet = alphabets.size();
+            numOfAcceptingStates = acceptingStates.size();
+        }
+        void addEpsilonTransition(const string& from, const string& to) {
+            epsilonTransitions[from].insert(to);
+            isAllowEpsilonTransitions = true;
+        }
+
+        // Subset construction: every reachable set of NFA states becomes one DFA state
+        void toDFA(DFA& dfa) const {
+            FA_METRIC_TIMER(DETERMINIZE_LATENCY);
+            map<set<string>, string> subsetNames;
+            vector<set<string>> pending;
+            set<string> start = {startState};
+            epsilonClosure(start);
+            subsetNames[start] = "q0";
+            pending.push_back(start);
+
+            for (char symbol : alphabets) {
+                dfa.addSymbol(symbol);
+            }
+            dfa.setStartState("q0");
+            int numAccepting = 0;
+            while (!pending.empty()) {
+                set<string> current = pending.back();
+                pending.pop_back();
+                string fromName = subsetNames[current];
+                dfa.addStates(fromName);
+                for (const string& state : current) {
+                    if (acceptingStates.find(state) != acceptingStates.end()) {
+                        dfa.addAcceptingStates(fromName);
+                        numAccepting++;
+                        break;
+                    }
+                }
+                for (char symbol : alphabets) {
+                    set<string> next = move(current, symbol);
+                    if (next.empty()) continue;
+                    auto known = subsetNames.find(next);
+                    if (known == subsetNames.end()) {
+                        string name = "q" + to_string(subsetNames.size());
+                        known = subsetNames.insert({next, name}).first;
+                        pending.push_back(next);
+                    }
+                    dfa.addTransition(fromName, symbol, known->second);
+                }
+            }
+            FA_METRIC_ADD(DETERMINIZED_STATES, subsetNames.size());
+            dfa.setNumOfState(subsetNames.size());
+            dfa.setNumOfAlphabet(alphabets.size());
+            dfa.setNumOfAcceptingState(numAccepting);
+        }
+
+        // Getters for database operations
+        const map<pair<string,char>, set<string>>& getTransitions() const { return transitions; }
+        const map<string, set<string>>& getEpsilonTransitions() const { return epsilonTransitions; }
+        const string& getStartState() const { return startState; }
+        const set<string>& getAcceptingStates() const { return acceptingStates; }
+        void handleInputForNFA(){
+            cout << "======== Designing NFA ========="<<endl;
+            bool isValid = false;
+            do{
+                cout << "Is this NFA have epsilon transitions?(y/n): ";
+                char choice;
+                cin >> choice;
+                if(choice == 'y' || choice == 'n'){
+                    isValid = true;
+                    isAllowEpsilonTransitions = choice = 'y' ? true : false; 
+                }else{
+                    cout << "Error: Invalid choice. Please enter y or n."<<endl;
+                }
+            }while(!isValid);
+            int numStates;
+            do{
+                cout << "Enter number of states : ";
+                cin >> numStates;
+                if(numStates <= 0){
+                    cout << "Error: Number of states must be greater than 0."<< endl;
+                }
+            }while(numStates <= 0);
+            numOfStates = numStates;
+            string notransition = "nt";
+            addStates(notransition);
+            for(int i = 0 ; i < numOfStates ; i++){
+                string state = "q" + to_string(i);
+                addStates(state);
+            }
+            int numAlphabet;
+            do{
+                cout << "Enter number of symbols : ";
+                cin >> numAlphabet;
+                if(numAlphabet <= 0){
+                    cout << "Error: Number of symbols must be greater than 0." << endl;
+                }
+            }while(numAlphabet <=0 );
+            numOfAlphabet = numAlphabet;
+            for(int i = 0 ; i < numOfAlphabet ; i++){
+                char symbol;
+                cout << "Enter symbol " << i+1 << ": ";
+                cin >> symbol;
+                addSymbol(symbol);
+            }
+            cout << "You have " << numOfStates << " states there're ";
+            displayState();
+            cout << " and " << numOfAlphabet << " symbols there're ";
+            displaySymbol();
+            cout << "in your NFA." << endl;
+            string state_state;
+            do{
+                cout << "Enter start state : ";
+                cin >> state_state;
+                if(states.find(state_state)== states.end()){
+                    cout << "Error: Start state must be one of the defined states." << endl;
+                }
+            }while(states.find(state_state) == states.end());
+            startState = state_state;
+            int numOfAcc;
+            do{
+                cout << "Enter number of accepting states : ";
+                cin >> numOfAcc;
+                if(numOfAcc <= 0){
+                    cout << "Error: Number of accepting states must be greater than 0."<< endl;
+                }
+            }while(numOfAcc <= 0);
+            numOfAcceptingStates = numOfAcc;
+            for(int i = 0 ;i < numOfAcceptingStates ; i++){
+                string acceptingState;
+                do{
+                    cout << "Enter accepting state " << i+1 << ": ";
+                    cin >> acceptingState;
+                    if(states.find(acceptingState) == states.end()){
+                        cout << "Error: Accepting state must be one of the defined states." << endl;
+                    }
+                }while(states.find(acceptingState) == states.end());
+                addAcceptingStates(acceptingState);
+            }
+            for(const auto& state : states){
+                for(const auto& alphabet : alphabets){
+                    char choice;
+                    do{
+                        string toState;
+                        do{
+                            cout << "Enter transition from state "<<state  << " with symbol " << alphabet << " to state(for no transition you can enter (nf) : ";
+                            cin >> toState;
+                            if(states.find(toState) == states.end()){
+                                cout << "Error: Transition state must be one of the defined states." << endl;
+                            }
+                        }while(states.find(toState) == states.end());
+                        addTransition(state, alphabet, toState);
+                        do{
+                            cout << "Is there another transition from state "<<state<<" with symbol "<<alphabet<<"? (y/n): ";
+                            cin >> choice;
+                            if(choice != 'y' && choice !='n'){
+                                cout << "Error: Invalid choice. Please enter y or n."<<endl;
+                            }
+                        }while(choice != 'y' && choice != 'n');
+                        
+                    }while(choice == 'y');
+                }
+            }
+            cout << "\nNFA created successfully!"<<endl;
+            char isSave;
+            do{
+                cout << "Do you want to save this NFA to Database? (y/n): ";
+                cin >> isSave;
+                if(isSave == 'y'){
+                    saveToDatabase();
+                }
+                if(isSave !='y' && isSave != 'n' ){
+                    cout << "Error: Invalid choice. Please enter y or n." << endl;
+                }
+            }while(isSave != 'y' && isSave != 'n');
+        }
+
+        // ✅ ADD: Display NFA transitions (different from DFA)
+        void displayTransitions() const {
+            cout << "\n📋 NFA Transition Table:" << endl;
+            cout << "------------------------" << endl;
+            for (const auto& transition : transitions) {
+                const string& fromState = transition.first.first;
+                const char& symbol = transition.first.second;
+                const set<string>& toStates = transition.second;
+                
+                cout << fromState << " --" << symbol << "--> ";
+                displayStateSet(toStates);
+                cout << endl;
+            }
+            for (const auto& transition : epsilonTransitions) {
+                cout << transition.first << " --ε--> ";
+                displayStateSet(transition.second);
+                cout << endl;
+            }
+            cout << endl;
+        }
+};
+
+// Compiles a regular expression straight into an NFA, without going through
+// the interactive prompts. Supported syntax: literals, escapes (\n \t \r \f \v
+// \xHH \x{H...} \uHHHH \d \w \s \D \W \S, and a backslash before any
+// punctuation; other letters and digits are errors), '.', character classes ([a-z],
+// [^...]), grouping ((...), (?:...)), alternation, *, +, ? and counted
+// repetition {m}, {m,}, {m,n}. '^' and '$' anchor a top-level branch to the
+// start/end of the input; an unanchored side matches any surrounding text, so
+// "ab" accepts "xaby". Patterns and inputs are UTF-8: '.' and classes match
+// whole code points, compiled into byte-level transitions.
+class RegexCompiler {
+    public:
+        enum Construction { THOMPSON, GLUSHKOV };
+
+    private:
+        // UTF8 nodes hold byte sequences for the non-ASCII part of a class,
+        // each as a chain of byte range charset nodes
+        enum NodeType { CHARSET, UTF8, EMPTY, CONCAT, ALTERNATE, STAR };
+        // Sorted, disjoint byte ranges of a CHARSET node
+        typedef vector<pair<unsigned char,unsigned char>> ByteRanges;
+        // 'size' bounds the number of program states the subtree builds into;
+        // 'height' is the recursion depth the constructions need for it
+        struct Node {
+            NodeType type;
+            ByteRanges bytes;
+            vector<int> kids;
+            int sequences;
+            long long size;
+            int height;
+        };
+        // Transition of the compiled program; charset == -1 is an epsilon move
+        struct Edge {
+            int charset;
+            int to;
+        };
+        struct GlushkovInfo {
+            bool nullable;
+            vector<int> first;
+            vector<int> last;
+        };
+        typedef vector<pair<uint32_t,uint32_t>> RangeList;
+        static constexpr int MAX_REPEAT = 1000;
+        static constexpr long long MAX_PROGRAM_STATES = 1 << 20;
+        // Parsing and both constructions recurse once per level of nesting
+        static constexpr int MAX_NESTING = 1000;
+
+        string pattern;
+        size_t pos = 0;
+        string error;
+        vector<Node> nodes;
+        vector<vector<vector<int>>> sequenceTables;
+        map<int,int> byteRangeCharsets;
+        RangeList universe;
+        int anyLoop = -1;
+
+        vector<vector<Edge>> program;
+        vector<int> programAccepting;
+        int programStart = 0;
+
+        vector<int> positionCharset;
+        vector<vector<int>> follow;
+
+        // Shared subtrees are built once per use, so counted repetition can
+        // blow up; patterns past MAX_PROGRAM_STATES are rejected here, as are
+        // trees deeper than MAX_NESTING (stacked quantifiers nest too)
+        int makeNode(NodeType type, const vector<int>& kids = {}) {
+            long long size = type == EMPTY ? 1 : type == CONCAT ? 0 : 2;
+            int height = 1;
+            for (int kid : kids) {
+                size = min(size + nodes[kid].size, MAX_PROGRAM_STATES + 1);
+                height = max(height, nodes[kid].height + 1);
+            }
+            if (size > MAX_PROGRAM_STATES) {
+                fail("Pattern expands to more than " + to_string(MAX_PROGRAM_STATES) + " states");
+            }
+            if (height > MAX_NESTING) {
+                fail("Pattern nests deeper than " + to_string(MAX_NESTING) + " levels");
+            }
+            nodes.push_back({type, ByteRanges(), kids, -1, size, height});
+            return nodes.size() - 1;
+        }
+        int makeCharset(const ByteRanges& bytes) {
+            nodes.push_back({CHARSET, bytes, {}, -1, 2, 1});
+            return nodes.size() - 1;
+        }
+        // Charset node for the byte range [lo, hi], shared by all UTF-8 sequences
+        // and literals. Only called while parsing: construction must not grow 'nodes'.
+        int byteRangeCharset(unsigned char lo, unsigned char hi) {
+            int key = lo << 8 | hi;
+            auto known = byteRangeCharsets.find(key);
+            if (known != byteRangeCharsets.end()) return known->second;
+            int node = makeCharset({{lo, hi}});
+            byteRangeCharsets[key] = node;
+            return node;
+        }
+        bool fail(const string& message) {
+            if (error.empty()) {
+                error = message + " at position " + to_string(pos);
+            }
+            return false;
+        }
+        bool atEnd() const { return pos >= pattern.size(); }
+
+        static void normalize(RangeList& ranges) {
+            sort(ranges.begin(), ranges.end());
+            RangeList merged;
+            for (const auto& range : ranges) {
+                if (!merged.empty() && range.first <= merged.back().second + 1) {
+                    merged.back().second = max(merged.back().second, range.second);
+                } else {
+                    merged.push_back(range);
+                }
+            }
+            ranges.swap(merged);
+        }
+
+        // universe minus ranges; both must be normalized
+        RangeList negate(const RangeList& ranges) const {
+            RangeList result;
+            size_t i = 0;
+            for (auto allowed : universe) {
+                uint32_t next = allowed.first;
+                while (i < ranges.size() && ranges[i].second < next) i++;
+                for (size_t j = i; j < ranges.size() && ranges[j].first <= allowed.second; j++) {
+                    if (ranges[j].first > next) result.push_back({next, ranges[j].first - 1});
+                    next = max(next, ranges[j].second + 1);
+                }
+                if (next <= allowed.second) result.push_back({next, allowed.second});
+            }
+            return result;
+        }
+
+        // ASCII code points become one byte charset, the rest UTF-8 sequences
+        int makeClass(RangeList ranges) {
+            // Plain ASCII literals share one node per byte
+            if (ranges.size() == 1 && ranges[0].first == ranges[0].second && ranges[0].first < 0x80) {
+                return byteRangeCharset(ranges[0].first, ranges[0].first);
+            }
+            normalize(ranges);
+            ByteRanges ascii;
+            vector<Utf8Sequence> sequences;
+            for (const auto& range : ranges) {
+                if (range.first <= 0x7F) {
+                    ascii.push_back({(unsigned char)range.first, (unsigned char)min<uint32_t>(range.second, 0x7F)});
+                }
+                if (range.second >= 0x80) {
+                    vector<Utf8Sequence> part = utf8Sequences(max<uint32_t>(range.first, 0x80), range.second);
+                    sequences.insert(sequences.end(), part.begin(), part.end());
+                }
+            }
+            int asciiNode = !ascii.empty() ? makeCharset(ascii) : -1;
+            if (sequences.empty()) {
+                return asciiNode >= 0 ? asciiNode : makeCharset(ascii);
+            }
+            vector<vector<int>> chains;
+            for (const Utf8Sequence& sequence : sequences) {
+                vector<int> chain;
+                for (const auto& range : sequence) chain.push_back(byteRangeCharset(range.first, range.second));
+                chains.push_back(chain);
+            }
+            sequenceTables.push_back(chains);
+            int utf8Node = makeNode(UTF8);
+            nodes[utf8Node].sequences = sequenceTables.size() - 1;
+            for (const vector<int>& chain : chains) nodes[utf8Node].size += chain.size() - 1;
+            return asciiNode >= 0 ? makeNode(ALTERNATE, {asciiNode, utf8Node}) : utf8Node;
+        }
+
+        static int hexValue(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        bool parseHex(size_t digits, uint32_t& value) {
+            value = 0;
+            for (size_t i = 0; i < digits; i++) {
+                if (atEnd() || hexValue(pattern[pos]) < 0) return fail("Invalid hex escape");
+                value = value * 16 + hexValue(pattern[pos++]);
+            }
+            return true;
+        }
+
+        // Decode the UTF-8 encoded code point starting at pos
+        bool parseLiteral(uint32_t& codePoint) {
+            unsigned char lead = pattern[pos];
+            int length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+            if (length == 0 || pos + length > pattern.size()) return fail("Invalid UTF-8 in pattern");
+            codePoint = length == 1 ? lead : lead & (0x7F >> length);
+            for (int i = 1; i < length; i++) {
+                unsigned char byte = pattern[pos + i];
+                if ((byte & 0xC0) != 0x80) return fail("Invalid UTF-8 in pattern");
+                codePoint = codePoint << 6 | (byte & 0x3F);
+            }
+            pos += length;
+            return true;
+        }
+
+        // Parse the escape after a backslash into a set of code points
+        bool parseEscape(RangeList& out) {
+            if (atEnd()) return fail("Trailing backslash");
+            char c = pattern[pos++];
+            RangeList shorthand;
+            uint32_t codePoint;
+            switch (c) {
+                case 'n': out.push_back({'\n', '\n'}); return true;
+                case 't': out.push_back({'\t', '\t'}); return true;
+                case 'r': out.push_back({'\r', '\r'}); return true;
+                case 'f': out.push_back({'\f', '\f'}); return true;
+                case 'v': out.push_back({'\v', '\v'}); return true;
+                case 'x':
+                    if (!atEnd() && pattern[pos] == '{') {
+                        size_t close = pattern.find('}', pos);
+                        if (close == string::npos || close == pos + 1 || close - pos > 7) return fail("Invalid \\x{...} escape");
+                        pos++;
+                        if (!parseHex(close - pos, codePoint)) return false;
+                        pos++;
+                    } else if (!parseHex(2, codePoint)) {
+                        return false;
+                    }
+                    if (codePoint > 0x10FFFF) return fail("Code point out of range");
+                    out.push_back({codePoint, codePoint});
+                    return true;
+                case 'u':
+                    if (!parseHex(4, codePoint)) return false;
+                    out.push_back({codePoint, codePoint});
+                    return true;
+                case 'd': case 'D':
+                    shorthand = {{'0', '9'}};
+                    break;
+                case 'w': case 'W':
+                    shorthand = {{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'}};
+                    break;
+                case 's': case 'S':
+                    shorthand = {{'\t', '\r'}, {' ', ' '}};
+                    break;
+                default:
+                    // Letters and digits may mean word boundaries, backreferences
+                    // and the like; only punctuation is escaped to itself
+                    if (isalnum((unsigned char)c)) {
+                        pos--;
+                        return fail(string("Unsupported escape \\") + c);
+                    }
+                    pos--;
+                    if (!parseLiteral(codePoint)) return false;
+                    out.push_back({codePoint, codePoint});
+                    return true;
+            }
+            if (c >= 'a') {
+                out.insert(out.end(), shorthand.begin(), shorthand.end());
+            } else {
+                RangeList negated = negate(shorthand);
+                out.insert(out.end(), negated.begin(), negated.end());
+            }
+            return true;
+        }
+
+        // One class member: a code point, a shorthand escape or a range
+        bool parseClassItem(RangeList& out) {
+            RangeList item;
+            if (pattern[pos] == '\\') {
+                pos++;
+                if (!parseEscape(item)) return false;
+            } else {
+                uint32_t codePoint;
+                if (!parseLiteral(codePoint)) return false;
+                item.push_back({codePoint, codePoint});
+            }
+            bool single = item.size() == 1 && item[0].first == item[0].second;
+            if (single && pos + 1 < pattern.size() && pattern[pos] == '-' && pattern[pos + 1] != ']') {
+                pos++;
+                RangeList upper;
+                if (pattern[pos] == '\\') {
+                    pos++;
+                    if (!parseEscape(upper)) return false;
+                } else {
+                    uint32_t codePoint;
+                    if (!parseLiteral(codePoint)) return false;
+                    upper.push_back({codePoint, codePoint});
+                }
+                if (upper.size() != 1 || upper[0].first != upper[0].second) return fail("Invalid class range");
+                if (item[0].first > upper[0].first) return fail("Class range out of order");
+                item[0].second = upper[0].first;
+            }
+            out.insert(out.end(), item.begin(), item.end());
+            return true;
+        }
+
+        bool parseClass(RangeList& out) {
+            bool negated = false;
+            if (!atEnd() && pattern[pos] == '^') {
+                negated = true;
+                pos++;
+            }
+            RangeList members;
+            bool first = true;
+            while (!atEnd() && (pattern[pos] != ']' || first)) {
+                first = false;
+                if (!parseClassItem(members)) return false;
+            }
+            if (atEnd()) return fail("Unterminated character class");
+            pos++;
+            normalize(members);
+            out = negated ? negate(members) : members;
+            return true;
+        }
+
+        bool parseCount(int& value) {
+            if (atEnd() || !isdigit((unsigned char)pattern[pos])) return fail("Expected repetition count");
+            value = 0;
+            while (!atEnd() && isdigit((unsigned char)pattern[pos])) {
+                value = value * 10 + (pattern[pos++] - '0');
+                if (value > MAX_REPEAT) return fail("Repetition count too large");
+            }
+            return true;
+        }
+
+        int parseRepeat(int atom) {
+            while (!atEnd() && error.empty()) {
+                char c = pattern[pos];
+                if (c == '*') {
+                    pos++;
+                    atom = makeNode(STAR, {atom});
+                } else if (c == '+') {
+                    pos++;
+                    atom = makeNode(CONCAT, {atom, makeNode(STAR, {atom})});
+                } else if (c == '?') {
+                    pos++;
+                    atom = makeNode(ALTERNATE, {atom, makeNode(EMPTY)});
+                } else if (c == '{') {
+                    pos++;
+                    int low = 0, high = 0;
+                    bool unbounded = false;
+                    if (!parseCount(low)) return -1;
+                    high = low;
+                    if (!atEnd() && pattern[pos] == ',') {
+                        pos++;
+                        if (!atEnd() && pattern[pos] == '}') {
+                            unbounded = true;
+                        } else if (!parseCount(high)) {
+                            return -1;
+                        }
+                    }
+                    if (atEnd() || pattern[pos] != '}') {
+                        fail("Unterminated repetition");
+                        return -1;
+                    }
+                    pos++;
+                    if (!unbounded && high < low) {
+                        fail("Repetition bounds out of order");
+                        return -1;
+                    }
+                    // The subtree is shared; each construction visit gets fresh states
+                    vector<int> copies(low, atom);
+                    if (unbounded) {
+                        copies.push_back(makeNode(STAR, {atom}));
+                    } else if (high > low) {
+                        int optional = makeNode(ALTERNATE, {atom, makeNode(EMPTY)});
+                        copies.insert(copies.end(), high - low, optional);
+                    }
+                    atom = copies.empty() ? makeNode(EMPTY) : makeNode(CONCAT, copies);
+                } else {
+                    break;
+                }
+            }
+            return atom;
+        }
+
+        int parseAtom(int depth) {
+            char c = pattern[pos++];
+            RangeList ranges;
+            uint32_t codePoint;
+            switch (c) {
+                case '(': {
+                    if (depth >= MAX_NESTING) {
+                        fail("Pattern nests deeper than " + to_string(MAX_NESTING) + " levels");
+                        return -1;
+                    }
+                    if (pattern.compare(pos, 2, "?:") == 0) pos += 2;
+                    int inner = parseAlternation(depth + 1);
+                    if (inner < 0) return -1;
+                    if (atEnd() || pattern[pos] != ')') {
+                        fail("Missing ')'");
+                        return -1;
+                    }
+                    pos++;
+                    return inner;
+                }
+                case '[':
+                    if (!parseClass(ranges)) return -1;
+                    return makeClass(ranges);
+                case '.':
+                    return makeClass(negate({{'\n', '\n'}}));
+                case '\\':
+                    if (!parseEscape(ranges)) return -1;
+                    return makeClass(ranges);
+                case '*': case '+': case '?': case '{':
+                    pos--;
+                    fail("Nothing to repeat");
+                    return -1;
+                default:
+                    pos--;
+                    if (!parseLiteral(codePoint)) return -1;
+                    return makeClass({{codePoint, codePoint}});
+            }
+        }
+
+        enum { START_ANCHOR = 1, END_ANCHOR = 2 };
+
+        // 'anchors' receives START_ANCHOR / END_ANCHOR for a top-level branch
+        int parseBranch(int depth, int& anchors) {
+            vector<int> items;
+            bool startAnchor = false, endAnchor = false;
+            while (!atEnd() && error.empty()) {
+                char c = pattern[pos];
+                if (c == '|' || c == ')') break;
+                if (c == '^') {
+                    if (depth > 0 || !items.empty() || startAnchor) {
+                        fail("'^' is only supported at the start of a top-level branch");
+                        return -1;
+                    }
+                    startAnchor = true;
+                    pos++;
+                    continue;
+                }
+                if (c == '$') {
+                    pos++;
+                    if (depth > 0 || (!atEnd() && pattern[pos] != '|')) {
+                        fail("'$' is only supported at the end of a top-level branch");
+                        return -1;
+                    }
+                    endAnchor = true;
+                    continue;
+                }
+                int atom = parseAtom(depth);
+                if (atom < 0) return -1;
+                atom = parseRepeat(atom);
+                if (atom < 0) return -1;
+                items.push_back(atom);
+            }
+            if (!error.empty()) return -1;
+            anchors = (startAnchor ? START_ANCHOR : 0) | (endAnchor ? END_ANCHOR : 0);
+            if (items.empty()) return makeNode(EMPTY);
+            if (items.size() == 1) return items[0];
+            return makeNode(CONCAT, items);
+        }
+
+        int parseAlternation(int depth) {
+            vector<int> branches;
+            vector<int> byAnchors[4];
+            int anchors = 0;
+            branches.push_back(parseBranch(depth, anchors));
+            byAnchors[anchors].push_back(branches.back());
+            while (branches.back() >= 0 && !atEnd() && pattern[pos] == '|') {
+                pos++;
+                branches.push_back(parseBranch(depth, anchors));
+                byAnchors[anchors].push_back(branches.back());
+            }
+            if (branches.back() < 0) return -1;
+            if (depth == 0) {
+                // Unanchored sides match any surrounding text; top-level branches
+                // with the same anchors share one pair of loops
+                branches.clear();
+                for (int kind = 0; kind < 4; kind++) {
+                    if (byAnchors[kind].empty()) continue;
+                    vector<int> items;
+                    if (!(kind & START_ANCHOR)) items.push_back(anyLoop);
+                    items.push_back(byAnchors[kind].size() == 1 ? byAnchors[kind][0] : makeNode(ALTERNATE, byAnchors[kind]));
+                    if (!(kind & END_ANCHOR)) items.push_back(anyLoop);
+                    branches.push_back(items.size() == 1 ? items[0] : makeNode(CONCAT, items));
+                }
+            }
+            if (branches.size() == 1) return branches[0];
+            return makeNode(ALTERNATE, branches);
+        }
+
+        int newState() {
+            program.emplace_back();
+            return program.size() - 1;
+        }
+
+        // Thompson construction: returns the {entry, exit} states of the fragment
+        pair<int,int> buildThompson(int node) {
+            switch (nodes[node].type) {
+                case CHARSET: {
+                    int s = newState(), e = newState();
+                    program[s].push_back({node, e});
+                    return {s, e};
+                }
+                case UTF8: {
+                    // Build each sequence back to front so common suffixes share states
+                    int s = newState(), e = newState();
+                    map<pair<int,int>,int> suffixStates;
+                    for (const vector<int>& chain : sequenceTables[nodes[node].sequences]) {
+                        int next = e;
+                        for (size_t i = chain.size() - 1; i > 0; i--) {
+                            int charset = chain[i];
+                            auto known = suffixStates.find({next, charset});
+                            if (known == suffixStates.end()) {
+                                int state = newState();
+                                program[state].push_back({charset, next});
+                                known = suffixStates.insert({{next, charset}, state}).first;
+                            }
+                            next = known->second;
+                        }
+                        program[s].push_back({chain[0], next});
+                    }
+                    return {s, e};
+                }
+                case EMPTY: {
+                    int s = newState();
+                    return {s, s};
+                }
+                case CONCAT: {
+                    pair<int,int> whole = buildThompson(nodes[node].kids[0]);
+                    for (size_t i = 1; i < nodes[node].kids.size(); i++) {
+                        pair<int,int> next = buildThompson(nodes[node].kids[i]);
+                        program[whole.second].push_back({-1, next.first});
+                        whole.second = next.second;
+                    }
+                    return whole;
+                }
+                case ALTERNATE: {
+                    int s = newState(), e = newState();
+                    for (size_t i = 0; i < nodes[node].kids.size(); i++) {
+                        pair<int,int> branch = buildThompson(nodes[node].kids[i]);
+                        program[s].push_back({-1, branch.first});
+                        program[branch.second].push_back({-1, e});
+                    }
+                    return {s, e};
+                }
+                case STAR: {
+                    int s = newState(), e = newState();
+                    pair<int,int> body = buildThompson(nodes[node].kids[0]);
+                    program[s].push_back({-1, body.first});
+                    program[s].push_back({-1, e});
+                    program[body.second].push_back({-1, body.first});
+                    program[body.second].push_back({-1, e});
+                    return {s, e};
+                }
+            }
+            return {-1, -1};
+        }
+
+        // Glushkov construction: one position per charset leaf visited
+        GlushkovInfo buildGlushkov(int node) {
+            GlushkovInfo info{false, {}, {}};
+            switch (nodes[node].type) {
+                case CHARSET: {
+                    int position = positionCharset.size();
+                    positionCharset.push_back(node);
+                    follow.emplace_back();
+                    info.first.push_back(position);
+                    info.last.push_back(position);
+                    break;
+                }
+                case UTF8:
+                    // One chain of positions per sequence
+                    for (const vector<int>& chain : sequenceTables[nodes[node].sequences]) {
+                        int previous = -1;
+                        for (int charset : chain) {
+                            int position = positionCharset.size();
+                            positionCharset.push_back(charset);
+                            follow.emplace_back();
+                            if (previous < 0) {
+                                info.first.push_back(position);
+                            } else {
+                                follow[previous].push_back(position);
+                            }
+                            previous = position;
+                        }
+                        info.last.push_back(previous);
+                    }
+                    break;
+                case EMPTY:
+                    info.nullable = true;
+                    break;
+                case CONCAT: {
+                    info.nullable = true;
+                    for (size_t i = 0; i < nodes[node].kids.size(); i++) {
+                        GlushkovInfo kid = buildGlushkov(nodes[node].kids[i]);
+                        for (int p : info.last) {
+                            follow[p].insert(follow[p].end(), kid.first.begin(), kid.first.end());
+                        }
+                        if (info.nullable) {
+                            info.first.insert(info.first.end(), kid.first.begin(), kid.first.end());
+                        }
+                        if (kid.nullable) {
+                            info.last.insert(info.last.end(), kid.last.begin(), kid.last.end());
+                        } else {
+                            info.last = kid.last;
+                        }
+                        info.nullable = info.nullable && kid.nullable;
+                    }
+                    break;
+                }
+                case ALTERNATE:
+                    for (size_t i = 0; i < nodes[node].kids.size(); i++) {
+                        GlushkovInfo kid = buildGlushkov(nodes[node].kids[i]);
+                        info.nullable = info.nullable || kid.nullable;
+                        info.first.insert(info.first.end(), kid.first.begin(), kid.first.end());
+                        info.last.insert(info.last.end(), kid.last.begin(), kid.last.end());
+                    }
+                    break;
+                case STAR: {
+                    info = buildGlushkov(nodes[node].kids[0]);
+                    info.nullable = true;
+                    for (int p : info.last) {
+                        follow[p].insert(follow[p].end(), info.first.begin(), info.first.end());
+                    }
+                    break;
+                }
+            }
+            return info;
+        }
+
+        void buildProgram(int root, Construction construction) {
+            program.clear();
+            programAccepting.clear();
+            if (construction == THOMPSON) {
+                pair<int,int> whole = buildThompson(root);
+                programStart = whole.first;
+                programAccepting.push_back(whole.second);
+                return;
+            }
+            positionCharset.clear();
+            follow.clear();
+            GlushkovInfo info = buildGlushkov(root);
+            // State 0 is the initial state, state p + 1 is position p
+            program.resize(positionCharset.size() + 1);
+            programStart = 0;
+            for (int p : info.first) {
+                program[0].push_back({positionCharset[p], p + 1});
+            }
+            for (size_t p = 0; p < follow.size(); p++) {
+                sort(follow[p].begin(), follow[p].end());
+                follow[p].erase(unique(follow[p].begin(), follow[p].end()), follow[p].end());
+                for (int q : follow[p]) {
+                    program[p + 1].push_back({positionCharset[q], q + 1});
+                }
+            }
+            if (info.nullable) programAccepting.push_back(0);
+            sort(info.last.begin(), info.last.end());
+            info.last.erase(unique(info.last.begin(), info.last.end()), info.last.end());
+            for (int p : info.last) {
+                programAccepting.push_back(p + 1);
+            }
+        }
+
+        void emit(CompiledNFA& compiled) const {
+            compiled.clear();
+            for (size_t i = 0; i < program.size(); i++) compiled.addState();
+            for (size_t i = 0; i < program.size(); i++) {
+                for (const Edge& edge : program[i]) {
+                    if (edge.charset < 0) {
+                        compiled.addEpsilon(i, edge.to);
+                        continue;
+                    }
+                    for (const auto& range : nodes[edge.charset].bytes) {
+                        compiled.addEdge(i, range.first, range.second, edge.to);
+                    }
+                }
+            }
+            compiled.setStart(programStart);
+            for (int state : programAccepting) compiled.setAccepting(state);
+        }
+
+    public:
+        RegexCompiler() {
+            // '.' and negated classes draw from every code point
+            universe = {{0, 0x10FFFF}};
+        }
+
+        const string& getError() const { return error; }
+        int getNumOfProgramStates() const { return program.size(); }
+
+        // Compact output; this is the fast path for large pattern sets
+        bool compile(const string& regex, Construction construction, CompiledNFA& compiled) {
+            FA_METRIC_TIMER(REGEX_COMPILE_LATENCY);
+            pattern = regex;
+            pos = 0;
+            error.clear();
+            nodes.clear();
+            sequenceTables.clear();
+            byteRangeCharsets.clear();
+            // Unanchored ends skip raw bytes; no need to decode code points there
+            anyLoop = makeNode(STAR, {makeCharset({{0x00, 0xFF}})});
+
+            int root = parseAlternation(0);
+            if (root >= 0 && !atEnd()) {
+                fail("Unmatched ')'");
+            }
+            if (!error.empty()) {
+                cout << "❌ Invalid regular expression: " << error << endl;
+                return false;
+            }
+            buildProgram(root, construction);
+            FA_METRIC_ADD(REGEX_STATES, program.size());
+            emit(compiled);
+            return true;
+        }
+
+        // String-keyed output for editing; much slower to build than the compact form
+        bool compile(const string& regex, Construction construction, NFA& nfa) {
+            CompiledNFA compiled;
+            if (!compile(regex, construction, compiled)) return false;
+            nfa.loadCompiled(compiled);
+            return true;
+        }
+};
+
+#ifndef _WIN32
+// Set from the signal handler and read by every worker thread; lock-free
+// atomics are safe in both places, unlike a volatile flag shared by threads
+atomic<bool> serverReloadRequested{false};
+atomic<bool> serverStopRequested{false};
+
+void handleServerSignal(int signal) {
+    if (signal == SIGHUP) {
+        serverReloadRequested = true;
+    } else {
+        serverStopRequested = true;
+    }
+}
+
+// Daemon mode: keeps compiled DFAs keyed by database ID and answers match
+// requests over a UNIX domain socket. Frames use native byte order:
+//   request:  u32 length | u8 op | u32 automaton id | input bytes
+//   response: u32 length | u8 status | u8 accepted
+// where length counts the bytes after the length field. Clients may pipeline
+// requests; each connection gets its responses back in request order.
+// The automata live in an immutable snapshot that a reload replaces
+// atomically, so matches already running keep the snapshot they started with.
+// Reloads run on the main thread; a connection that sent OP_RELOAD is parked
+// until its answer is ready, while the workers keep serving everyone else.
+class MatchServer {
+    public:
+        enum Op { OP_MATCH = 1, OP_RELOAD = 2, OP_PING = 3 };
+        enum Status { STATUS_OK = 0, STATUS_UNKNOWN_AUTOMATON = 1, STATUS_BAD_REQUEST = 2, STATUS_RELOAD_FAILED = 3 };
+        typedef map<int, shared_ptr<const CompiledDFA>> Snapshot;
+
+    private:
+        static constexpr uint32_t HEADER_SIZE = 5;
+        static constexpr uint32_t MAX_FRAME = 16 << 20;
+        struct Connection {
+            int fd;
+            string in;
+            string out;
+            bool closing = false;
+            // Set by OP_RELOAD; the connection then belongs to the main thread,
+            // unarmed in epoll, until the reload is answered
+            bool reloadPending = false;
+            uint32_t reloadId = 0;
+        };
+        struct ReloadRequest {
+            Connection* connection;
+            uint32_t id;
+        };
+
+        string socketPath;
+        int numWorkers;
+        int listenFd = -1;
+        int epollFd = -1;
+        shared_ptr<const Snapshot> snapshot = make_shared<const Snapshot>();
+        mutex reloadMutex;
+        mutex pendingMutex;
+        condition_variable reloadWakeup;
+        vector<ReloadRequest> pendingReloads;
+        // Every open connection, so the ones still open or parked when the
+        // server stops can be closed
+        mutex connectionsMutex;
+        set<Connection*> connections;
+
+        shared_ptr<const Snapshot> currentSnapshot() const {
+            return atomic_load(&snapshot);
+        }
+
+        static shared_ptr<const CompiledDFA> loadAutomaton(int id) {
+            DFA::LoadResult result;
+            shared_ptr<const DFA> dfa = DFA::fetchShared(id, result, false);
+            if (!dfa) {
+                return nullptr;
+            }
+            shared_ptr<const CompiledDFA> automaton = make_shared<const CompiledDFA>(*dfa);
+            FA_METRIC_MEMORY(id, automaton->memoryUsage());
+            return automaton;
+        }
+
+        void rearm(int fd, void* ptr, uint32_t events) {
+            epoll_event event{};
+            event.events = events | EPOLLONESHOT;
+            event.data.ptr = ptr;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
         }
-        
-        void addTransition(const string& from, char symbol, const string& to) {
-            transitions[{from, symbol}].insert(to);
+
+        void acceptConnections() {
+            while (true) {
+                int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) break;
+                Connection* connection = new Connection();
+                connection->fd = fd;
+                {
+                    lock_guard<mutex> lock(connectionsMutex);
+                    connections.insert(connection);
+                }
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+                event.data.ptr = connection;
+                epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+            }
+            rearm(listenFd, nullptr, EPOLLIN);
         }
-        void handleInputForNFA(){
-            cout << "======== Designing NFA ========="<<endl;
-            bool isValid = false;
-            do{
-                cout << "Is this NFA have epsilon transitions?(y/n): ";
-                char choice;
-                cin >> choice;
-                if(choice == 'y' || choice == 'n'){
-                    isValid = true;
-                    isAllowEpsilonTransitions = choice = 'y' ? true : false; 
-                }else{
-                    cout << "Error: Invalid choice. Please enter y or n."<<endl;
+
+        static void appendResponse(string& out, uint8_t status, uint8_t accepted) {
+            uint32_t length = 2;
+            out.append((const char*)&length, sizeof(length));
+            out += (char)status;
+            out += (char)accepted;
+        }
+
+        // Answer every complete frame in the input buffer. Stops at OP_RELOAD,
+        // which handleConnection hands to the main thread; later frames wait
+        // for its answer.
+        void processFrames(Connection& connection) {
+            shared_ptr<const Snapshot> automata = currentSnapshot();
+            size_t offset = 0;
+            while (connection.in.size() - offset >= sizeof(uint32_t)) {
+                uint32_t length;
+                memcpy(&length, connection.in.data() + offset, sizeof(length));
+                if (length < HEADER_SIZE || length > MAX_FRAME) {
+                    appendResponse(connection.out, STATUS_BAD_REQUEST, 0);
+                    connection.closing = true;
+                    break;
                 }
-            }while(!isValid);
-            int numStates;
-            do{
-                cout << "Enter number of states : ";
-                cin >> numStates;
-                if(numStates <= 0){
-                    cout << "Error: Number of states must be greater than 0."<< endl;
+                if (connection.in.size() - offset - sizeof(uint32_t) < length) break;
+                const char* frame = connection.in.data() + offset + sizeof(uint32_t);
+                uint8_t op = frame[0];
+                uint32_t id;
+                memcpy(&id, frame + 1, sizeof(id));
+                offset += sizeof(uint32_t) + length;
+                FA_METRIC_ADD(SERVER_REQUESTS, 1);
+
+                if (op == OP_MATCH) {
+                    auto automaton = automata->find(id);
+                    if (automaton == automata->end()) {
+                        appendResponse(connection.out, STATUS_UNKNOWN_AUTOMATON, 0);
+                    } else {
+                        string input(frame + HEADER_SIZE, length - HEADER_SIZE);
+                        appendResponse(connection.out, STATUS_OK, automaton->second->matches(input));
+                    }
+                } else if (op == OP_RELOAD) {
+                    connection.reloadPending = true;
+                    connection.reloadId = id;
+                    break;
+                } else if (op == OP_PING) {
+                    appendResponse(connection.out, STATUS_OK, 0);
+                } else {
+                    appendResponse(connection.out, STATUS_BAD_REQUEST, 0);
                 }
-            }while(numStates <= 0);
-            numOfStates = numStates;
-            string notransition = "nt";
-            addStates(notransition);
-            for(int i = 0 ; i < numOfStates ; i++){
-                string state = "q" + to_string(i);
-                addStates(state);
             }
-            int numAlphabet;
-            do{
-                cout << "Enter number of symbols : ";
-                cin >> numAlphabet;
-                if(numAlphabet <= 0){
-                    cout << "Error: Number of symbols must be greater than 0." << endl;
+            connection.in.erase(0, offset);
+        }
+
+        void handleConnection(Connection* connection, uint32_t events) {
+            char buffer[65536];
+            if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                while (true) {
+                    ssize_t received = recv(connection->fd, buffer, sizeof(buffer), 0);
+                    if (received > 0) {
+                        connection->in.append(buffer, received);
+                        continue;
+                    }
+                    if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                        connection->closing = true;
+                    }
+                    break;
                 }
-            }while(numAlphabet <=0 );
-            numOfAlphabet = numAlphabet;
-            for(int i = 0 ; i < numOfAlphabet ; i++){
-                char symbol;
-                cout << "Enter symbol " << i+1 << ": ";
-                cin >> symbol;
-                addSymbol(symbol);
             }
-            cout << "You have " << numOfStates << " states there're ";
-            displayState();
-            cout << " and " << numOfAlphabet << " symbols there're ";
-            displaySymbol();
-            cout << "in your NFA." << endl;
-            string state_state;
-            do{
-                cout << "Enter start state : ";
-                cin >> state_state;
-                if(states.find(state_state)== states.end()){
-                    cout << "Error: Start state must be one of the defined states." << endl;
+            // Also resumes frames queued behind a reload that has been answered
+            processFrames(*connection);
+            while (!connection->out.empty()) {
+                ssize_t sent = send(connection->fd, connection->out.data(), connection->out.size(), MSG_NOSIGNAL);
+                if (sent <= 0) {
+                    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                        connection->out.clear();
+                        connection->closing = true;
+                    }
+                    break;
                 }
-            }while(states.find(state_state) == states.end());
-            startState = state_state;
-            int numOfAcc;
-            do{
-                cout << "Enter number of accepting states : ";
-                cin >> numOfAcc;
-                if(numOfAcc <= 0){
-                    cout << "Error: Number of accepting states must be greater than 0."<< endl;
+                connection->out.erase(0, sent);
+            }
+            if (connection->reloadPending) {
+                // Last access from this worker; the main thread takes over
+                {
+                    lock_guard<mutex> lock(pendingMutex);
+                    pendingReloads.push_back({connection, connection->reloadId});
                 }
-            }while(numOfAcc <= 0);
-            numOfAcceptingStates = numOfAcc;
-            for(int i = 0 ;i < numOfAcceptingStates ; i++){
-                string acceptingState;
-                do{
-                    cout << "Enter accepting state " << i+1 << ": ";
-                    cin >> acceptingState;
-                    if(states.find(acceptingState) == states.end()){
-                        cout << "Error: Accepting state must be one of the defined states." << endl;
+                reloadWakeup.notify_one();
+                return;
+            }
+            if (connection->closing && connection->out.empty()) {
+                closeConnection(connection);
+                return;
+            }
+            rearm(connection->fd, connection, EPOLLIN | EPOLLRDHUP | (connection->out.empty() ? 0u : (uint32_t)EPOLLOUT));
+        }
+
+        void closeConnection(Connection* connection) {
+            {
+                lock_guard<mutex> lock(connectionsMutex);
+                connections.erase(connection);
+            }
+            close(connection->fd);
+            delete connection;
+        }
+
+        void workerLoop() {
+            epoll_event events[64];
+            while (!serverStopRequested) {
+                int ready = epoll_wait(epollFd, events, 64, 200);
+                for (int i = 0; i < ready; i++) {
+                    if (events[i].data.ptr == nullptr) {
+                        acceptConnections();
+                    } else {
+                        handleConnection((Connection*)events[i].data.ptr, events[i].events);
                     }
-                }while(states.find(acceptingState) == states.end());
-                addAcceptingStates(acceptingState);
+                }
             }
-            for(const auto& state : states){
-                for(const auto& alphabet : alphabets){
-                    char choice;
-                    do{
-                        string toState;
-                        do{
-                            cout << "Enter transition from state "<<state  << " with symbol " << alphabet << " to state(for no transition you can enter (nf) : ";
-                            cin >> toState;
-                            if(states.find(toState) == states.end()){
-                                cout << "Error: Transition state must be one of the defined states." << endl;
-                            }
-                        }while(states.find(toState) == states.end());
-                        addTransition(state, alphabet, toState);
-                        do{
-                            cout << "Is there another transition from state "<<state<<" with symbol "<<alphabet<<"? (y/n): ";
-                            cin >> choice;
-                            if(choice != 'y' && choice !='n'){
-                                cout << "Error: Invalid choice. Please enter y or n."<<endl;
-                            }
-                        }while(choice != 'y' && choice != 'n');
-                        
-                    }while(choice == 'y');
+        }
+
+        bool listen() {
+            listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (listenFd < 0 || socketPath.size() >= sizeof(address.sun_path)) {
+                cout << "❌ Failed to create socket " << socketPath << endl;
+                return false;
+            }
+            strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+            unlink(socketPath.c_str());
+            if (bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 || ::listen(listenFd, SOMAXCONN) < 0) {
+                cout << "❌ Failed to listen on " << socketPath << ": " << strerror(errno) << endl;
+                return false;
+            }
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLONESHOT;
+            event.data.ptr = nullptr;
+            return epollFd >= 0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+        }
+
+    public:
+        MatchServer(const string& path, int workers) : socketPath(path), numWorkers(max(1, workers)) {}
+
+        ~MatchServer() {
+            if (epollFd >= 0) close(epollFd);
+            if (listenFd >= 0) {
+                close(listenFd);
+                unlink(socketPath.c_str());
+            }
+        }
+
+        // Load the given automata into a new snapshot and publish it. Automata
+        // that fail to load keep their previous version.
+        bool reload(const vector<int>& ids) {
+            lock_guard<mutex> lock(reloadMutex);
+            shared_ptr<Snapshot> next = make_shared<Snapshot>(*currentSnapshot());
+            bool allLoaded = true;
+            for (int id : ids) {
+                shared_ptr<const CompiledDFA> automaton = loadAutomaton(id);
+                if (automaton) {
+                    (*next)[id] = automaton;
+                } else {
+                    cout << "❌ Failed to load DFA " << id << ", keeping previous version" << endl;
+                    allLoaded = false;
                 }
             }
-            cout << "\nNFA created successfully!"<<endl;
-            char isSave;
-            do{
-                cout << "Do you want to save this NFA to Database? (y/n): ";
-                cin >> isSave;
-                if(isSave == 'y'){
-                    saveToDatabase();
+            atomic_store(&snapshot, shared_ptr<const Snapshot>(next));
+            return allLoaded;
+        }
+
+        bool reloadAll() {
+            vector<int> ids;
+            for (const auto& automaton : *currentSnapshot()) {
+                ids.push_back(automaton.first);
+            }
+            return reload(ids);
+        }
+
+        // Serve until SIGINT/SIGTERM; SIGHUP reloads every automaton
+        bool run() {
+            if (!listen()) return false;
+            signal(SIGHUP, handleServerSignal);
+            signal(SIGINT, handleServerSignal);
+            signal(SIGTERM, handleServerSignal);
+            signal(SIGPIPE, SIG_IGN);
+            cout << "🚀 Serving " << currentSnapshot()->size() << " DFAs on " << socketPath
+                 << " with " << numWorkers << " workers" << endl;
+
+            vector<thread> workers;
+            for (int i = 0; i < numWorkers; i++) {
+                workers.emplace_back(&MatchServer::workerLoop, this);
+            }
+            while (!serverStopRequested) {
+                vector<ReloadRequest> requests;
+                {
+                    unique_lock<mutex> lock(pendingMutex);
+                    reloadWakeup.wait_for(lock, chrono::milliseconds(200), [&] { return !pendingReloads.empty(); });
+                    requests.swap(pendingReloads);
                 }
-                if(isSave !='y' && isSave != 'n' ){
-                    cout << "Error: Invalid choice. Please enter y or n." << endl;
+                if (serverReloadRequested.exchange(false)) {
+                    cout << "🔄 Reloading DFAs..." << endl;
+                    reloadAll();
                 }
-            }while(isSave != 'y' && isSave != 'n');
+                for (const ReloadRequest& request : requests) {
+                    bool reloaded = request.id == 0 ? reloadAll() : reload({(int)request.id});
+                    Connection* connection = request.connection;
+                    appendResponse(connection->out, reloaded ? STATUS_OK : STATUS_RELOAD_FAILED, 0);
+                    connection->reloadPending = false;
+                    // Hand the connection back to the workers to send the answer
+                    rearm(connection->fd, connection, EPOLLIN | EPOLLRDHUP | EPOLLOUT);
+                }
+            }
+            for (thread& worker : workers) {
+                worker.join();
+            }
+            // Only this thread is left: close what is still open or parked
+            pendingReloads.clear();
+            vector<Connection*> remaining(connections.begin(), connections.end());
+            for (Connection* connection : remaining) {
+                closeConnection(connection);
+            }
+            cout << "👋 Server stopped." << endl;
+            return true;
         }
+};
+#endif
 
-        // ✅ ADD: Display NFA transitions (different from DFA)
-        void displayTransitions() const {
-            cout << "\n📋 NFA Transition Table:" << endl;
-            cout << "------------------------" << endl;
-            for (const auto& transition : transitions) {
-                const string& fromState = transition.first.first;
-                const char& symbol = transition.first.second;
-                const set<string>& toStates = transition.second;
-                
-                cout << fromState << " --" << symbol << "--> {";
-                bool first = true;
-                for (const string& toState : toStates) {
-                    if (!first) cout << ", ";
-                    cout << toState;
-                    first = false;
+// Usage: main --serve <socket path> <workers> <dfa id>...
+int runServer(int argc, char* argv[]) {
+#ifdef _WIN32
+    cout << "Server mode requires UNIX domain sockets and is not available on Windows." << endl;
+    return 1;
+#else
+    if (argc < 5) {
+        cout << "Usage: " << argv[0] << " --serve <socket path> <workers> <dfa id>..." << endl;
+        return 1;
+    }
+    MatchServer server(argv[2], atoi(argv[3]));
+    vector<int> ids;
+    for (int i = 4; i < argc; i++) {
+        ids.push_back(atoi(argv[i]));
+    }
+    server.reload(ids);
+    return server.run() ? 0 : 1;
+#endif
+}
+
+// Compile 'pattern' with the given construction and determinize it
+bool compileRegexToDFA(const string& pattern, RegexCompiler::Construction construction, CompiledDFA& compiled) {
+    CompiledNFA nfa;
+    RegexCompiler compiler;
+    if (!compiler.compile(pattern, construction, nfa)) return false;
+    compiled = CompiledDFA(nfa.determinize());
+    return true;
+}
+
+// Regression checks, run with 'main --self-test'. Prints one line per failed
+// check and returns the number of failures.
+int runSelfTest() {
+    int failures = 0;
+    auto check = [&](bool ok, const string& what) {
+        if (!ok) {
+            cout << "❌ " << what << endl;
+            failures++;
+        }
+    };
+
+    // Thompson and Glushkov must agree on multi-byte classes inside
+    // concatenation and repetition
+    const char* patterns[] = {
+        "^[α-ω][α-ω]$", "^(α|β)+$", "^[α-ω]{2,3}$", "^x[^a-z]*y$", "^(é|€|😀)(a|€)*$", "€.😀", "^[\\x{80}-\\x{10FFFF}]+$"
+    };
+    const char* pieces[] = {"α", "β", "ω", "a", "x", "y", "é", "€", "😀", "\x7f"};
+    uint32_t seed = 12345;
+    auto random = [&](uint32_t bound) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % bound;
+    };
+    for (const char* pattern : patterns) {
+        CompiledDFA thompson, glushkov;
+        check(compileRegexToDFA(pattern, RegexCompiler::THOMPSON, thompson), string("Thompson compiles ") + pattern);
+        check(compileRegexToDFA(pattern, RegexCompiler::GLUSHKOV, glushkov), string("Glushkov compiles ") + pattern);
+        // The compact output must agree with the NFA it expands into
+        CompiledNFA compactThompson, compactGlushkov;
+        RegexCompiler().compile(pattern, RegexCompiler::THOMPSON, compactThompson);
+        RegexCompiler().compile(pattern, RegexCompiler::GLUSHKOV, compactGlushkov);
+        // Determinizing the compact form must give the automaton the
+        // string-keyed NFA::toDFA builds, table and all
+        NFA expanded;
+        RegexCompiler().compile(pattern, RegexCompiler::THOMPSON, expanded);
+        DFA viaStrings, loaded;
+        expanded.toDFA(viaStrings);
+        CompiledDFA reference(viaStrings);
+        loaded.loadCompiled(compactThompson.determinize());
+        CompiledDFA reloaded(loaded);
+        check(reference.getNumOfStates() == thompson.getNumOfStates() && reference.getNumOfClasses() == thompson.getNumOfClasses()
+              && reloaded.getNumOfStates() == thompson.getNumOfStates(),
+              string("compact determinization differs in size on ") + pattern);
+        for (int i = 0; i < 500; i++) {
+            string input;
+            for (uint32_t length = random(5); length > 0; length--) input += pieces[random(10)];
+            bool expected = thompson.matches(input);
+            check(expected == glushkov.matches(input),
+                  string("constructions disagree on ") + pattern + " / '" + input + "'");
+            check(expected == compactThompson.matches(input) && expected == compactGlushkov.matches(input),
+                  string("compact NFA disagrees on ") + pattern + " / '" + input + "'");
+            check(expected == reference.matches(input) && expected == reloaded.matches(input),
+                  string("compact determinization disagrees on ") + pattern + " / '" + input + "'");
+        }
+    }
+    CompiledDFA pair;
+    compileRegexToDFA("^[α-ω][α-ω]$", RegexCompiler::THOMPSON, pair);
+    check(pair.matches("αβ") && !pair.matches("α"), "Thompson ^[α-ω][α-ω]$ on 'αβ' / 'α'");
+    CompiledDFA repeat;
+    compileRegexToDFA("^(α|β)+$", RegexCompiler::THOMPSON, repeat);
+    check(repeat.matches("αβ") && repeat.matches("β") && !repeat.matches(""), "Thompson ^(α|β)+$");
+
+    // Deep nesting and unsupported escapes are compile errors, not crashes or
+    // silently different patterns
+    auto rejects = [&](const string& pattern) {
+        streambuf* output = cout.rdbuf(nullptr);
+        CompiledNFA compiled;
+        bool accepted = RegexCompiler().compile(pattern, RegexCompiler::GLUSHKOV, compiled);
+        cout.rdbuf(output);
+        return !accepted;
+    };
+    check(rejects(string(100000, '(') + "a" + string(100000, ')')), "100000 nested groups are rejected");
+    check(rejects("a" + string(100000, '*')), "100000 stacked quantifiers are rejected");
+    check(!rejects(string(500, '(') + "a" + string(500, ')')), "500 nested groups compile");
+    check(rejects("^\\bfoo$") && rejects("^(a)\\1$") && rejects("\\Q"), "letter and digit escapes are rejected");
+    CompiledDFA punctuation;
+    check(compileRegexToDFA("^\\.\\-\\[$", RegexCompiler::GLUSHKOV, punctuation) && punctuation.matches(".-[")
+          && !punctuation.matches("a-["), "punctuation escapes are literals");
+
+    // Byte 0x00 is an ordinary symbol, and '.' and negated classes cover
+    // control characters
+    for (RegexCompiler::Construction construction : {RegexCompiler::THOMPSON, RegexCompiler::GLUSHKOV}) {
+        CompiledDFA nul, negated, dot;
+        compileRegexToDFA("^a\\x00b$", construction, nul);
+        check(nul.matches(string("a\0b", 3)) && !nul.matches("ab"), "^a\\x00b$ treats 0x00 as a symbol");
+        compileRegexToDFA("^[^a]$", construction, negated);
+        check(negated.matches("\x01") && negated.matches(string(1, '\0')) && !negated.matches("a"), "[^a] matches control characters");
+        compileRegexToDFA("^.$", construction, dot);
+        check(dot.matches("\x7f") && dot.matches("\x1b") && !dot.matches("\n"), ". matches control characters");
+    }
+    NFA ranges;
+    ranges.addCodePointRange("from", 0, 0x7F, "to");
+    check(ranges.getEpsilonTransitions().empty() && ranges.getTransitions().count({"from", '\0'}) == 1,
+          "addCodePointRange from 0 adds a 0x00 transition");
+
+    // Incremental refreshes must agree with a full rebuild: never join states
+    // the rebuild separates, and join all of them whenever isExact() holds
+    auto compareWithRebuild = [&](DFA& dfa, const string& what) {
+        const DFAAnalysis& incremental = dfa.refresh();
+        DFAAnalysis full;
+        full.rebuild(dfa.getStates(), dfa.getAlphabet(), dfa.getAcceptingStates(), dfa.getStartState(), dfa.getTransitions());
+        for (const string& first : dfa.getStates()) {
+            check(incremental.isReachable(first) == full.isReachable(first), what + ": reachability of " + first);
+            for (const string& second : dfa.getStates()) {
+                bool joined = incremental.areEquivalent(first, second);
+                bool equivalent = full.areEquivalent(first, second);
+                check(!joined || equivalent, what + ": refresh joins " + first + " and " + second);
+                check(joined || !equivalent || !incremental.isExact(), what + ": exact refresh separates " + first + " and " + second);
+            }
+        }
+    };
+    {
+        DFA dfa;
+        for (int i = 0; i < 6; i++) {
+            string state = "s" + to_string(i);
+            dfa.addStates(state);
+        }
+        dfa.addSymbol('a');
+        dfa.addSymbol('b');
+        dfa.setStartState("s4");
+        int edges[][3] = {{0,'a',3}, {0,'b',2}, {1,'a',0}, {1,'b',2}, {2,'a',0}, {3,'a',0}, {4,'a',3}, {4,'b',5}, {5,'a',4}, {5,'b',3}};
+        for (auto& edge : edges) dfa.addTransition("s" + to_string(edge[0]), (char)edge[1], "s" + to_string(edge[2]));
+        dfa.refresh();
+        dfa.addAcceptingStates("s3");
+        compareWithRebuild(dfa, "accepting s3");
+    }
+    // Half the automata start without accepting states, so the first
+    // accepting edit splits one large class several ways at once
+    for (int trial = 0; trial < 2000; trial++) {
+        DFA dfa;
+        int n = 2 + random(12);
+        string symbols = random(2) ? "ab" : "abc";
+        for (int i = 0; i < n; i++) {
+            string state = "q" + to_string(i);
+            dfa.addStates(state);
+        }
+        for (char symbol : symbols) dfa.addSymbol(symbol);
+        dfa.setStartState("q0");
+        for (int i = 0; i < n; i++) {
+            if (trial % 2 && random(3) == 0) dfa.addAcceptingStates("q" + to_string(i));
+            for (char symbol : symbols) {
+                if (random(5)) dfa.addTransition("q" + to_string(i), symbol, "q" + to_string(random(n)));
+            }
+        }
+        dfa.refresh();
+        for (int edit = 0; edit < 12; edit++) {
+            uint32_t kind = random(10);
+            if (kind < 6) {
+                dfa.addTransition("q" + to_string(random(n)), symbols[random(symbols.size())], "q" + to_string(random(n)));
+            } else if (kind < 8) {
+                dfa.addAcceptingStates("q" + to_string(random(n)));
+            } else if (kind < 9) {
+                string state = "q" + to_string(n++);
+                dfa.addStates(state);
+            } else {
+                dfa.setStartState("q" + to_string(random(n)));
+            }
+            compareWithRebuild(dfa, "random DFA " + to_string(trial));
+        }
+    }
+    // Past REGION_BUDGET classes a refresh may come out inexact;
+    // refresh(true) must still reach the rebuild's minimal DFA. Minimal DFAs
+    // are named in BFS order, so equal languages give identical tables.
+    bool sawInexact = false;
+    for (int n : {6000, 20000, 60000}) {
+        DFA dfa;
+        for (int i = 0; i < n; i++) {
+            string state = "q" + to_string(i);
+            dfa.addStates(state);
+        }
+        string symbols = n == 20000 ? "abc" : "ab";
+        for (char symbol : symbols) dfa.addSymbol(symbol);
+        dfa.setStartState("q0");
+        for (int i = 0; i < n; i++) {
+            if (random(4) == 0) dfa.addAcceptingStates("q" + to_string(i));
+            for (char symbol : symbols) dfa.addTransition("q" + to_string(i), symbol, "q" + to_string(random(n)));
+        }
+        dfa.refresh();
+        for (int edit = 0; edit < 20; edit++) {
+            uint32_t kind = random(4);
+            if (kind < 2) {
+                dfa.addTransition("q" + to_string(random(n)), symbols[random(symbols.size())], "q" + to_string(random(n)));
+            } else if (kind < 3) {
+                dfa.addAcceptingStates("q" + to_string(random(n)));
+            } else {
+                string state = "q" + to_string(n++);
+                dfa.addStates(state);
+                dfa.addTransition("q" + to_string(random(n)), symbols[0], state);
+            }
+            sawInexact = sawInexact || !dfa.refresh().isExact();
+        }
+        const DFAAnalysis& minimized = dfa.refresh(true);
+        DFAAnalysis full;
+        full.rebuild(dfa.getStates(), dfa.getAlphabet(), dfa.getAcceptingStates(), dfa.getStartState(), dfa.getTransitions());
+        DFA fromRefresh, fromRebuild;
+        minimized.toMinimalDFA(fromRefresh);
+        full.toMinimalDFA(fromRebuild);
+        check(minimized.isExact() && fromRefresh.getTransitions() == fromRebuild.getTransitions()
+              && fromRefresh.getAcceptingStates() == fromRebuild.getAcceptingStates(),
+              "refresh(true) minimizes a " + to_string(n) + "-state DFA like a rebuild");
+    }
+    check(sawInexact, "large edits exercise an inexact refresh");
+
+    // Intermediate states of a code point range must not reuse a state that
+    // already exists, whether loaded from JSON or named by the user
+    {
+        NFA saved;
+        saved.addCodePointRange("s", 0x3B1, 0x3C9, "t");
+        saved.setStartState("s");
+        saved.addAcceptingStates("t");
+        string file = "temp_self_test_nfa.json";
+        ofstream json(file);
+        json << saved.toJSON("greek");
+        json.close();
+        NFA loaded;
+        loaded.fromJSON(file);
+        remove(file.c_str());
+        loaded.addCodePointRange("s", 0x410, 0x44F, "x");
+        string named = "u0";
+        NFA user;
+        user.addStates(named);
+        user.addSymbol('z');
+        user.addTransition("s", 'z', "u0");
+        user.setStartState("s");
+        user.addCodePointRange("s", 0x3B1, 0x3C9, "t");
+        user.addAcceptingStates("t");
+        DFA loadedDFA, userDFA;
+        loaded.toDFA(loadedDFA);
+        user.toDFA(userDFA);
+        CompiledDFA loadedCompiled(loadedDFA), userCompiled(userDFA);
+        check(loadedCompiled.matches("α") && !loadedCompiled.matches("б"), "code point range reuses a loaded state");
+        check(userCompiled.matches("α") && !userCompiled.matches("z\xb1"), "code point range reuses a user state");
+    }
+
+    // MultiDFA must agree with matching every automaton on its own: with a
+    // warm product, when the product cache overflows, after falling back to
+    // direct stepping and after returning to the product
+    {
+        const char* symbolPool = "ab\xce\xb1\xb2\xff";
+        vector<shared_ptr<const CompiledDFA>> automata;
+        for (int a = 0; a < 12; a++) {
+            DFA dfa;
+            int n = 3 + random(18);
+            for (int i = 0; i < n; i++) {
+                string state = "q" + to_string(i);
+                dfa.addStates(state);
+                if (random(3) == 0) dfa.addAcceptingStates(state);
+            }
+            dfa.setStartState("q0");
+            for (int i = 0; i < n; i++) {
+                for (const char* symbol = symbolPool; *symbol; symbol++) {
+                    if (random(6)) dfa.addTransition("q" + to_string(i), *symbol, "q" + to_string(random(n)));
                 }
-                cout << "}" << endl;
             }
-            cout << endl;
+            automata.push_back(make_shared<const CompiledDFA>(dfa));
         }
-};
+        const char* inputPieces[] = {"a", "b", "α", "β", "\xce", "\xff", "ab"};
+        auto randomInput = [&](uint32_t maxPieces) {
+            string input;
+            for (uint32_t length = random(maxPieces + 1); length > 0; length--) input += inputPieces[random(7)];
+            return input;
+        };
+        auto agrees = [&](MultiDFA& engine, const string& input) {
+            vector<int> expected;
+            for (size_t a = 0; a < automata.size(); a++) {
+                if (automata[a]->matches(input)) expected.push_back(a);
+            }
+            return engine.evaluate(input) == expected;
+        };
+
+        MultiDFA warm;
+        for (size_t a = 0; a < automata.size(); a++) warm.add(a, automata[a]);
+        bool correct = true;
+        for (int i = 0; i < 300; i++) correct = agrees(warm, randomInput(10)) && correct;
+        check(correct && !warm.isSteppingDirectly() && warm.getNumOfProductStatesBuilt() == warm.getNumOfProductStates(),
+              "MultiDFA with a warm product");
+
+        // A small cache: mostly repeated inputs overflow it now and then but
+        // keep the hit rate up, so the product stays in use
+        size_t limit = 64 << 10;
+        MultiDFA small(limit, 20000);
+        for (size_t a = 0; a < automata.size(); a++) small.add(a, automata[a]);
+        vector<string> repeated;
+        for (int i = 0; i < 8; i++) repeated.push_back(randomInput(10));
+        bool everDirect = false;
+        size_t peakBytes = 0;
+        int peakStates = 0;
+        for (int i = 0; i < 4000; i++) {
+            correct = agrees(small, random(10) ? repeated[random(8)] : randomInput(30)) && correct;
+            everDirect = everDirect || small.isSteppingDirectly();
+            peakBytes = max(peakBytes, small.getProductCacheBytes());
+            peakStates = max(peakStates, small.getNumOfProductStates());
+        }
+        check(correct && !everDirect && small.getNumOfProductStatesBuilt() > peakStates && peakBytes <= 2 * limit,
+              "MultiDFA keeps an overflowing product with a good hit rate");
+
+        // Only new inputs: the hit rate collapses, the automata are stepped
+        // directly with the cache freed, and the product is retried later
+        bool sawDirect = false, sawReturn = false;
+        for (int i = 0; i < 4000 && !sawReturn; i++) {
+            correct = agrees(small, randomInput(30)) && correct;
+            if (small.isSteppingDirectly()) {
+                sawDirect = true;
+                correct = correct && small.getProductCacheBytes() == 0;
+            } else if (sawDirect) {
+                sawReturn = true;
+            }
+        }
+        for (int i = 0; i < 100; i++) correct = agrees(small, randomInput(30)) && correct;
+        check(correct && sawDirect && sawReturn, "MultiDFA falls back to direct stepping and returns to the product");
+    }
+
+    // Cache: LRU eviction, blobs checked against their hash, and versions
+    // changed or dropped by another process (a second cache on the same
+    // directory) are never served from memory
+    {
+        string directory = "fa_cache_self_test";
+        string one = "{\"name\": \"one\"}", two = "{\"name\": \"two\"}", three = "{\"name\": \"three\"}";
+        string newer = "{\"name\": \"three, edited\"}";
+        shared_ptr<const DFA> automaton = make_shared<const DFA>(), found;
+        string content;
+        {
+            AutomatonCache cache(directory, 2), other(directory, 2);
+            cache.store(1, one, automaton);
+            cache.store(2, two, automaton);
+            cache.store(3, three, automaton);
+            check(cache.getStats().evictions == 1, "cache evicts beyond its capacity");
+            found = nullptr;
+            check(cache.lookup(1, found, content) && !found && content == one, "evicted entry is a disk hit");
+            check(cache.lookup(3, found, content) && found == automaton && cache.getStats().memoryHits == 1,
+                  "recent entry is a memory hit");
+
+            ofstream corrupt(directory + "/" + contentHash(two) + ".json", ios::binary | ios::trunc);
+            corrupt << "{\"name\": \"owt\"}";
+            corrupt.close();
+            check(!other.lookup(2, found, content), "corrupted blob is a miss");
+
+            other.store(3, newer, automaton);
+            found = nullptr;
+            check(cache.lookup(3, found, content) && !found && content == newer, "version stored elsewhere replaces memory entry");
+            cache.store(3, newer, automaton);
+            other.invalidate(3);
+            check(!cache.lookup(3, found, content), "invalidation elsewhere drops memory entry");
+            check(cache.getStats().misses == 1 && cache.getStats().diskHits == 2, "cache statistics");
+        }
+        for (const string& document : {one, two, three, newer}) {
+            remove((directory + "/" + contentHash(document) + ".json").c_str());
+        }
+        remove((directory + "/index.txt").c_str());
+        remove((directory + "/index.lock").c_str());
+        remove(directory.c_str());
+    }
+
+    if (failures == 0) {
+        cout << "✅ All self tests passed." << endl;
+    } else {
+        cout << "❌ " << failures << " self test check(s) failed." << endl;
+    }
+    return failures;
+}
 
 void menu(){
     cout << "--------- Finite Automaton Menu ---------" << endl;
@@ -708,6 +4616,8 @@ void menu(){
     cout << " 3. Convert NFA to DFA"<<endl;
     cout << " 4. Check type of FA"<<endl;
     cout << " 5. Minimize DFA"<<endl;
+    cout << " 6. Show DFA cache statistics"<<endl;
+    cout << " 7. Match a string against many DFAs from Database"<<endl;
     cout << " 0. exit "<<endl;
     cout << "please enter your choice: "<<endl;
 }
@@ -716,10 +4626,117 @@ void menuForDesignFA(){
     cout << "--------- Design Finite Automaton ---------" << endl;
     cout << " 1. Create DFA" << endl;
     cout << " 2. Create NFA" << endl;
+    cout << " 3. Build NFA from regular expression" << endl;
     cout << " 0. Back to main menu" << endl;
     cout << "please enter your choice: " << endl;
 }
 
+void handleInputForRegex(){
+    cout << "======== Regular Expression to NFA =========" << endl;
+    string pattern;
+    cout << "Enter regular expression : ";
+    cin >> ws;
+    getline(cin, pattern);
+    char construction;
+    do{
+        cout << "Construction: (t)hompson or (g)lushkov epsilon-free? : ";
+        cin >> construction;
+        if(construction != 't' && construction != 'g'){
+            cout << "Error: Invalid choice. Please enter t or g." << endl;
+        }
+    }while(construction != 't' && construction != 'g');
+
+    CompiledNFA nfa;
+    RegexCompiler compiler;
+    auto begin = chrono::steady_clock::now();
+    if(!compiler.compile(pattern, construction == 't' ? RegexCompiler::THOMPSON : RegexCompiler::GLUSHKOV, nfa)){
+        return;
+    }
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin);
+    cout << "\nNFA created successfully with " << nfa.getNumOfStates() << " states in "
+         << elapsed.count() << " us." << endl;
+    if(nfa.getNumOfStates() <= 50){
+        NFA display;
+        display.loadCompiled(nfa);
+        display.displayTransitions();
+    }
+
+    char testChoice;
+    cout << "\n🧪 Do you want to test the NFA? (y/n): ";
+    cin >> testChoice;
+    if(testChoice == 'y' || testChoice == 'Y') {
+        string testInput;
+        do {
+            cout << "Enter a string to test (or 'quit' to stop): ";
+            cin >> testInput;
+            if(testInput != "quit") {
+                cout << "\n" << string(30, '-') << endl;
+                if(nfa.matches(testInput)) {
+                    cout << "🎉 ACCEPTED!" << endl;
+                } else {
+                    cout << "💥 REJECTED!" << endl;
+                }
+                cout << string(30, '-') << endl;
+            }
+        } while(testInput != "quit");
+    }
+
+    char convertChoice;
+    cout << "\n🔁 Do you want to convert it to a DFA and save it to database? (y/n): ";
+    cin >> convertChoice;
+    if(convertChoice == 'y' || convertChoice == 'Y') {
+        CompiledNFA deterministic = nfa.determinize();
+        CompiledDFA compiled(deterministic);
+        DFA dfa;
+        dfa.loadCompiled(deterministic);
+        cout << "DFA has " << dfa.getNumOfState() << " states, compiled table uses "
+             << compiled.getNumOfClasses() << " byte classes (" << compiled.memoryUsage() << " bytes)." << endl;
+        dfa.saveToDatabase();
+    }
+}
+
+void handleInputForMultiMatch(){
+    cout << "=== Match against many DFAs from Database ===" << endl;
+    int numIds;
+    do{
+        cout << "Enter number of DFA IDs : ";
+        cin >> numIds;
+        if(numIds <= 0){
+            cout << "Error: Number of DFA IDs must be greater than 0." << endl;
+        }
+    }while(numIds <= 0);
+    MultiDFA engine;
+    for(int i = 0 ; i < numIds ; i++){
+        int id;
+        cout << "Enter DFA ID " << i+1 << ": ";
+        cin >> id;
+        DFA::LoadResult result;
+        shared_ptr<const DFA> dfa = DFA::fetchShared(id, result);
+        if(dfa){
+            engine.add(id, make_shared<const CompiledDFA>(*dfa));
+        }else{
+            cout << "❌ DFA with ID " << id << " could not be loaded, skipping." << endl;
+        }
+    }
+    cout << "✅ " << engine.getNumOfAutomata() << " DFAs ready." << endl;
+
+    string testInput;
+    do {
+        cout << "\nEnter string to test (or 'quit' to stop): ";
+        cin >> testInput;
+        if(testInput != "quit") {
+            vector<int> accepted = engine.evaluate(testInput);
+            cout << "\n" << string(40, '=') << endl;
+            cout << "🎯 Accepted by " << accepted.size() << " DFA(s):";
+            for(int id : accepted){
+                cout << " " << id;
+            }
+            cout << endl;
+            cout << string(40, '=') << endl;
+        }
+    } while(testInput != "quit");
+}
+
 void handleUserInputForMenu(){
     int choice;
     do{
@@ -742,6 +4759,9 @@ void handleUserInputForMenu(){
                             nfa.handleInputForNFA();
                         }
                         break;
+                        case 3 :
+                            handleInputForRegex();
+                            break;
                         case 0 :
                             cout << "Returning to main menu." << endl;
                             break;     
@@ -788,7 +4808,39 @@ void handleUserInputForMenu(){
             }
             break;
             case 5 : {
-                cout << "DFA minimization not implemented yet." << endl;
+                cout << "=== Minimize a DFA from Database ===" << endl;
+                cout << "Enter DFA ID to load: ";
+                int dfaId;
+                cin >> dfaId;
+                DFA dfa;
+                if(dfa.fetchFromDatabase(dfaId) != DFA::LOADED){
+                    cout << "❌ DFA with ID " << dfaId << " could not be loaded!" << endl;
+                    break;
+                }
+                const DFAAnalysis& analysis = dfa.refresh(true);
+                DFA minimal;
+                analysis.toMinimalDFA(minimal);
+                cout << "✅ " << dfa.getStates().size() << " states, " << analysis.getNumOfReachableStates()
+                     << " reachable, " << minimal.getNumOfState() << " in the minimal DFA." << endl;
+                if((size_t)minimal.getNumOfState() > DFAAnalysis::getRegionBudget()){
+                    cout << "ℹ️  Past " << DFAAnalysis::getRegionBudget() << " classes, edits keep these classes sound"
+                         << " but not provably minimal; minimizing again re-runs the full construction." << endl;
+                }
+                minimal.displayTransitions();
+                char saveChoice;
+                cout << "\n💾 Do you want to save the minimal DFA to database? (y/n): ";
+                cin >> saveChoice;
+                if(saveChoice == 'y' || saveChoice == 'Y') {
+                    minimal.saveToDatabase();
+                }
+            }
+            break;
+            case 6 : {
+                AutomatonCache::instance().displayStats();
+            }
+            break;
+            case 7 : {
+                handleInputForMultiMatch();
             }
             break;
             case 0 :
@@ -801,7 +4853,20 @@ void handleUserInputForMenu(){
     }while(choice != 0);
 }
 
-int main(){
-    handleUserInputForMenu();
-    return 0;
+int main(int argc, char* argv[]){
+#ifndef FA_NO_METRICS
+    Metrics::instance().startExporterFromEnvironment();
+#endif
+    int status = 0;
+    if(argc > 1 && string(argv[1]) == "--serve"){
+        status = runServer(argc, argv);
+    }else if(argc > 1 && string(argv[1]) == "--self-test"){
+        status = runSelfTest() == 0 ? 0 : 1;
+    }else{
+        handleUserInputForMenu();
+    }
+#ifndef FA_NO_METRICS
+    Metrics::instance().stopExporter();
+#endif
+    return status;
 }
\ No newline at end of file